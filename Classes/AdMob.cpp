@@ -1,33 +1,66 @@
-#include "AdMob.hpp"
+#include "AdMob.h"
 #include "scripting/js-bindings/manual/cocos2d_specifics.hpp"
 #include "scripting/js-bindings/manual/js_manual_conversions.h"
-#include "platform/android/jni/JniHelper.h"
-#include <jni.h>
+#include <map>
 #include <sstream>
 #include "base/CCDirector.h"
 #include "base/CCScheduler.h"
+#include "platform/CCFileUtils.h"
 #include "utils/PluginUtils.h"
+#include "AdMobAds.h"
+#include "AdMobArbiter.h"
+#include "AdMobAtoms.h"
+#include "AdMobBundles.h"
+#include "AdMobConfigDefaults.h"
+#include "AdMobLiveOps.h"
+#include "AdMobPacing.h"
+#include "AdMobPlatform.h"
+#include "AdMobSpool.h"
+#include "AdMobVariant.h"
+#include "AdMobWatchdog.h"
+#include "AdMobWorker.h"
 #include "firebase/app.h"
-#include "firebase/admob.h"
-#include "firebase/admob/banner_view.h"
-#include "firebase/admob/interstitial_ad.h"
 #include "firebase/remote_config.h"
 
 static std::string ApplicationId;
-static std::vector<std::string> testDeviceIds;
-static const char* testingDevices[100];
-static firebase::admob::AdRequest my_ad_request = {};
-static firebase::admob::BannerView *sharedBannerView = NULL;
-static firebase::admob::InterstitialAd *sharedInterstitialAd = NULL;
-static bool rewarded_inited = false;
 
 static void printLog(const char* str) {
     CCLOG("%s", str);
 }
 
 firebase::admob::AdParent getAdParent() {
-    // Returns the Android Activity.
-    return cocos2d::JniHelper::getActivity();
+    return sdkbar::admob::platformAdParent();
+}
+
+// Ad unit ids and Remote Config keys may be passed either as plain strings or
+// as atoms returned by admob.intern(). Atoms skip the string conversion.
+static bool jsval_to_admob_key(JSContext *cx, JS::HandleValue val, std::string *buffer, const char **key)
+{
+    if(val.isInt32()) {
+        *key = sdkbar::admob::atomString(val.toInt32());
+        return *key != NULL;
+    }
+    if(!jsval_to_std_string(cx, val, buffer)) {
+        return false;
+    }
+    *key = buffer->c_str();
+    return true;
+}
+
+// Ad unit ids are kept in the intern table so that the pointer can be stored
+// beyond the current call (settings, watchdog reports).
+static bool jsval_to_admob_ad_unit(JSContext *cx, JS::HandleValue val, const char **adUnit)
+{
+    if(val.isInt32()) {
+        *adUnit = sdkbar::admob::atomString(val.toInt32());
+        return *adUnit != NULL;
+    }
+    std::string buffer;
+    if(!jsval_to_std_string(cx, val, &buffer)) {
+        return false;
+    }
+    *adUnit = sdkbar::admob::atomString(sdkbar::admob::internString(buffer));
+    return true;
 }
 
 ///////////////////////////////////////
@@ -36,37 +69,100 @@ firebase::admob::AdParent getAdParent() {
 //
 ///////////////////////////////////////
 
+static void initPacing();
+static void reloadPlacementHints();
+
+static bool remoteConfigReady = false;
+
+// Applies a defaults blob from tools/build_config_defaults.py in one
+// SetDefaults call; keys and strings point into the loaded file.
+static bool applyConfigDefaults(const std::string &path) {
+    cocos2d::Data blob = cocos2d::FileUtils::getInstance()->getDataFromFile(path);
+    std::vector<firebase::remote_config::ConfigKeyValueVariant> defaults;
+    if(!sdkbar::admob::parseConfigDefaults(blob.getBytes(), blob.getSize(), &defaults)) {
+        printLog("Firebase: invalid config defaults");
+        return false;
+    }
+    ADMOB_SDK_CALL(kSlotConfig, "remote_config::SetDefaults", path.c_str(), firebase::remote_config::SetDefaults(defaults.data(), defaults.size()));
+    return true;
+}
+
+// Applies defaults given as a flat JS object of key: boolean/number/string/
+// ArrayBuffer; keys and values point into the converted Variant map.
+static bool applyConfigDefaults(JSContext *cx, JS::HandleValue value) {
+    firebase::Variant defaults;
+    if(!sdkbar::admob::jsvalToVariant(cx, value, &defaults)) {
+        return false;
+    }
+    if(!defaults.is_map()) {
+        JS_ReportError(cx, "Invalid config defaults");
+        return false;
+    }
+    const std::map<firebase::Variant, firebase::Variant> &items = defaults.map();
+    std::vector<firebase::remote_config::ConfigKeyValueVariant> entries;
+    entries.reserve(items.size());
+    for(std::map<firebase::Variant, firebase::Variant>::const_iterator it = items.begin(); it != items.end(); ++it) {
+        if(it->second.is_container_type()) {
+            JS_ReportError(cx, "Nested config default %s", it->first.string_value());
+            return false;
+        }
+        firebase::remote_config::ConfigKeyValueVariant entry;
+        entry.key = it->first.string_value();
+        // strings and blobs are referenced, the map outlives SetDefaults
+        if(it->second.is_string()) {
+            entry.value = firebase::Variant::FromStaticString(it->second.string_value());
+        } else if(it->second.is_blob()) {
+            entry.value = firebase::Variant::FromStaticBlob(it->second.blob_data(), it->second.blob_size());
+        } else {
+            entry.value = it->second;
+        }
+        entries.push_back(entry);
+    }
+    ADMOB_SDK_CALL(kSlotConfig, "remote_config::SetDefaults", NULL, firebase::remote_config::SetDefaults(entries.data(), entries.size()));
+    return true;
+}
+
 static bool jsb_admob_init(JSContext *cx, uint32_t argc, jsval *vp)
 {
     printLog("jsb_admob_init");
+    ADMOB_TRACE(kTraceJsEntry, kSlotNone, "jsb_admob_init");
     JS::CallArgs args = JS::CallArgsFromVp(argc, vp);
     JS::RootedObject obj(cx, args.thisv().toObjectOrNull());
     JS::CallReceiver rec = JS::CallReceiverFromVp(vp);
-    if(argc == 1) {
+    if(argc == 1 || argc == 2) {
+        // app id, optional Remote Config defaults blob path
         bool ok = true;
         std::string advertisingId;
+        std::string defaultsPath;
         JS::RootedValue arg0Val(cx, args.get(0));
         ok &= jsval_to_std_string(cx, arg0Val, &advertisingId);
+        if(argc == 2) {
+            JS::RootedValue arg1Val(cx, args.get(1));
+            ok &= jsval_to_std_string(cx, arg1Val, &defaultsPath);
+        }
 
         printLog("[AdMob] Init plugin");
-#if (CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID)
-        // Initialize Firebase for Android.
-        firebase::App* app = firebase::App::Create(firebase::AppOptions(), cocos2d::JniHelper::getEnv(), cocos2d::JniHelper::getActivity());
-        // Initialize AdMob.
-        firebase::admob::Initialize(*app, advertisingId.c_str());
-#elif (CC_TARGET_PLATFORM == CC_PLATFORM_IOS)
-        // Initialize Firebase for iOS.
-        firebase::App* app = firebase::App::Create(firebase::AppOptions());
+        // ad telemetry is spooled to disk until read_telemetry/ack_telemetry
+        sdkbar::admob::openSpool(cocos2d::FileUtils::getInstance()->getWritablePath() + "admob_telemetry.spool");
+        // Initialize Firebase.
+        firebase::App* app = sdkbar::admob::createFirebaseApp();
         // Initialize AdMob.
-        firebase::admob::Initialize(*app, advertisingId.c_str());
-#endif
+        sdkbar::admob::Ads::initialize(*app, advertisingId.c_str());
+        // tuning bundles come from Storage when the module is built in
+        sdkbar::admob::useStorageBundleSource(app);
         if(firebase::remote_config::Initialize(*app) == firebase::kInitResultSuccess) {
+            remoteConfigReady = true;
+            if(!defaultsPath.empty()) {
+                applyConfigDefaults(defaultsPath);
+            }
             if(firebase::remote_config::ActivateFetched()) {
                 printLog("Firebase: activate fetched config");
             }
             firebase::remote_config::Fetch();
+            reloadPlacementHints();
         }
         ApplicationId = advertisingId;
+        initPacing();
         rec.rval().set(JSVAL_TRUE);
         return true;
     } else {
@@ -78,22 +174,12 @@ static bool jsb_admob_init(JSContext *cx, uint32_t argc, jsval *vp)
 static bool jsb_admob_launch_test_suite(JSContext *cx, uint32_t argc, jsval *vp)
 {
     printLog("jsb_admob_launch_test_suite");
+    ADMOB_TRACE(kTraceJsEntry, kSlotNone, "jsb_admob_launch_test_suite");
     JS::CallArgs args = JS::CallArgsFromVp(argc, vp);
     JS::RootedObject obj(cx, args.thisv().toObjectOrNull());
     JS::CallReceiver rec = JS::CallReceiverFromVp(vp);
     if(argc == 0) {
-        if(ApplicationId.size() > 0) {
-
-            cocos2d::JniMethodInfo methodInfo;
-            if (! cocos2d::JniHelper::getStaticMethodInfo(methodInfo, "com/google/android/ads/mediationtestsuite/MediationTestSuite", "launch", "(Landroid/content/Context;Ljava/lang/String;)V")) {
-                rec.rval().set(JSVAL_FALSE);
-                return false;
-            }
-            jstring str = methodInfo.env->NewStringUTF(ApplicationId.c_str());
-            methodInfo.env->CallStaticVoidMethod(methodInfo.classID, methodInfo.methodID, cocos2d::JniHelper::getActivity(), str);
-            methodInfo.env->DeleteLocalRef(str);
-            methodInfo.env->DeleteLocalRef(methodInfo.classID);
-
+        if(ApplicationId.size() > 0 && sdkbar::admob::launchMediationTestSuite(ApplicationId)) {
             rec.rval().set(JSVAL_TRUE);
         } else {
             rec.rval().set(JSVAL_FALSE);
@@ -108,6 +194,7 @@ static bool jsb_admob_launch_test_suite(JSContext *cx, uint32_t argc, jsval *vp)
 static bool jsb_admob_add_test_device(JSContext *cx, uint32_t argc, jsval *vp)
 {
     printLog("jsb_admob_add_test_device");
+    ADMOB_TRACE(kTraceJsEntry, kSlotNone, "jsb_admob_add_test_device");
     JS::CallArgs args = JS::CallArgsFromVp(argc, vp);
     JS::RootedObject obj(cx, args.thisv().toObjectOrNull());
     JS::CallReceiver rec = JS::CallReceiverFromVp(vp);
@@ -117,14 +204,144 @@ static bool jsb_admob_add_test_device(JSContext *cx, uint32_t argc, jsval *vp)
         std::string deviceId;
         JS::RootedValue arg0Val(cx, args.get(0));
         ok &= jsval_to_std_string(cx, arg0Val, &deviceId);
-        testDeviceIds.push_back(deviceId);
+        sdkbar::admob::Ads::addTestDevice(deviceId);
+        rec.rval().set(JSVAL_TRUE);
+        return true;
+    } else {
+        JS_ReportError(cx, "Invalid number of arguments");
+        return false;
+    }
+}
+
+static bool jsb_admob_set_off_thread_sdk_calls(JSContext *cx, uint32_t argc, jsval *vp)
+{
+    printLog("jsb_admob_set_off_thread_sdk_calls");
+    JS::CallArgs args = JS::CallArgsFromVp(argc, vp);
+    JS::RootedObject obj(cx, args.thisv().toObjectOrNull());
+    JS::CallReceiver rec = JS::CallReceiverFromVp(vp);
+    if(argc == 1) {
+        // false while SDK calls of the current mode are still pending
+        JS::RootedValue arg0Val(cx, args.get(0));
+        if(sdkbar::admob::setOffThreadSdkCalls(JS::ToBoolean(arg0Val))) {
+            rec.rval().set(JSVAL_TRUE);
+        } else {
+            rec.rval().set(JSVAL_FALSE);
+        }
+        return true;
+    } else {
+        JS_ReportError(cx, "Invalid number of arguments");
+        return false;
+    }
+}
+
+static bool jsb_admob_intern(JSContext *cx, uint32_t argc, jsval *vp)
+{
+    printLog("jsb_admob_intern");
+    ADMOB_TRACE(kTraceJsEntry, kSlotNone, "jsb_admob_intern");
+    JS::CallArgs args = JS::CallArgsFromVp(argc, vp);
+    JS::RootedObject obj(cx, args.thisv().toObjectOrNull());
+    JS::CallReceiver rec = JS::CallReceiverFromVp(vp);
+    if(argc == 1) {
+        // ad unit id or config key
+        bool ok = true;
+        std::string str;
+        JS::RootedValue arg0Val(cx, args.get(0));
+        ok &= jsval_to_std_string(cx, arg0Val, &str);
+        if(!ok) {
+            JS_ReportError(cx, "Invalid string");
+            return false;
+        }
+        rec.rval().set(JS::Int32Value(sdkbar::admob::internString(str)));
+        return true;
+    } else {
+        JS_ReportError(cx, "Invalid number of arguments");
+        return false;
+    }
+}
+
+static bool jsb_admob_atom_string(JSContext *cx, uint32_t argc, jsval *vp)
+{
+    printLog("jsb_admob_atom_string");
+    ADMOB_TRACE(kTraceJsEntry, kSlotNone, "jsb_admob_atom_string");
+    JS::CallArgs args = JS::CallArgsFromVp(argc, vp);
+    JS::RootedObject obj(cx, args.thisv().toObjectOrNull());
+    JS::CallReceiver rec = JS::CallReceiverFromVp(vp);
+    if(argc == 1 && args.get(0).isInt32()) {
+        const char *str = sdkbar::admob::atomString(args.get(0).toInt32());
+        if(str != NULL) {
+            rec.rval().set(c_string_to_jsval(cx, str));
+        } else {
+            rec.rval().setNull();
+        }
+        return true;
+    } else {
+        JS_ReportError(cx, "Invalid arguments");
+        return false;
+    }
+}
+
+static bool jsb_admob_dump_trace(JSContext *cx, uint32_t argc, jsval *vp)
+{
+    JS::CallArgs args = JS::CallArgsFromVp(argc, vp);
+    JS::RootedObject obj(cx, args.thisv().toObjectOrNull());
+    JS::CallReceiver rec = JS::CallReceiverFromVp(vp);
+    if(argc == 0) {
+        // Chrome trace_event JSON, load it in chrome://tracing
+        std::string json = sdkbar::admob::traceToChromeJson();
+        rec.rval().set(std_string_to_jsval(cx, json));
+        return true;
+    } else {
+        JS_ReportError(cx, "Invalid number of arguments");
+        return false;
+    }
+}
 
-        my_ad_request.test_device_id_count = testDeviceIds.size();
-        for(int i=0; i<testDeviceIds.size(); i++) {
-            testingDevices[i] = testDeviceIds[i].c_str();
-            printLog(testDeviceIds[i].c_str());
+static bool jsb_admob_set_stall_budget(JSContext *cx, uint32_t argc, jsval *vp)
+{
+    JS::CallArgs args = JS::CallArgsFromVp(argc, vp);
+    JS::RootedObject obj(cx, args.thisv().toObjectOrNull());
+    JS::CallReceiver rec = JS::CallReceiverFromVp(vp);
+    if(argc == 1) {
+        // budget in milliseconds, 0 disables the watchdog
+        bool ok = true;
+        uint32_t budget = 0;
+        JS::RootedValue arg0Val(cx, args.get(0));
+        ok &= jsval_to_uint32(cx, arg0Val, &budget);
+        if(!ok) {
+            JS_ReportError(cx, "Invalid budget");
+            return false;
         }
-        my_ad_request.test_device_ids = testingDevices;
+        sdkbar::admob::setStallBudget(budget);
+        rec.rval().set(JSVAL_TRUE);
+        return true;
+    } else {
+        JS_ReportError(cx, "Invalid number of arguments");
+        return false;
+    }
+}
+
+static bool jsb_admob_get_stall_report(JSContext *cx, uint32_t argc, jsval *vp)
+{
+    JS::CallArgs args = JS::CallArgsFromVp(argc, vp);
+    JS::RootedObject obj(cx, args.thisv().toObjectOrNull());
+    JS::CallReceiver rec = JS::CallReceiverFromVp(vp);
+    if(argc == 0) {
+        std::string json = sdkbar::admob::stallReportToJson();
+        rec.rval().set(std_string_to_jsval(cx, json));
+        return true;
+    } else {
+        JS_ReportError(cx, "Invalid number of arguments");
+        return false;
+    }
+}
+
+static bool jsb_admob_clear_stall_report(JSContext *cx, uint32_t argc, jsval *vp)
+{
+    JS::CallArgs args = JS::CallArgsFromVp(argc, vp);
+    JS::RootedObject obj(cx, args.thisv().toObjectOrNull());
+    JS::CallReceiver rec = JS::CallReceiverFromVp(vp);
+    if(argc == 0) {
+        sdkbar::admob::clearStallReport();
         rec.rval().set(JSVAL_TRUE);
         return true;
     } else {
@@ -139,19 +356,75 @@ static bool jsb_admob_add_test_device(JSContext *cx, uint32_t argc, jsval *vp)
 //
 ///////////////////////////////////////
 
+static bool jsb_admob_set_config_defaults(JSContext *cx, uint32_t argc, jsval *vp)
+{
+    printLog("jsb_admob_set_config_defaults");
+    ADMOB_TRACE(kTraceJsEntry, kSlotConfig, "jsb_admob_set_config_defaults");
+    JS::CallArgs args = JS::CallArgsFromVp(argc, vp);
+    JS::RootedObject obj(cx, args.thisv().toObjectOrNull());
+    JS::CallReceiver rec = JS::CallReceiverFromVp(vp);
+    if(argc == 1) {
+        // defaults blob path, or an object of key: value
+        bool ok = true;
+        std::string path;
+        JS::RootedValue arg0Val(cx, args.get(0));
+        if(arg0Val.isObject()) {
+            if(!remoteConfigReady) {
+                rec.rval().set(JSVAL_FALSE);
+                return true;
+            }
+            if(!applyConfigDefaults(cx, arg0Val)) {
+                return false;
+            }
+            rec.rval().set(JSVAL_TRUE);
+            return true;
+        }
+        ok &= jsval_to_std_string(cx, arg0Val, &path);
+        if(!ok) {
+            JS_ReportError(cx, "Invalid path");
+            return false;
+        }
+        if(remoteConfigReady && applyConfigDefaults(path)) {
+            rec.rval().set(JSVAL_TRUE);
+        } else {
+            rec.rval().set(JSVAL_FALSE);
+        }
+        return true;
+    } else {
+        JS_ReportError(cx, "Invalid number of arguments");
+        return false;
+    }
+}
+
+// int32 when the value fits, otherwise a double (exact up to 2^53).
+static JS::Value int64_to_jsval(int64_t value) {
+    if(value >= INT32_MIN && value <= INT32_MAX) {
+        return JS::Int32Value((int32_t)value);
+    }
+    return JS::DoubleValue((double)value);
+}
+
 static bool jsb_admob_get_boolean(JSContext *cx, uint32_t argc, jsval *vp)
 {
     printLog("jsb_admob_get_boolean");
+    ADMOB_TRACE(kTraceJsEntry, kSlotConfig, "jsb_admob_get_boolean");
     JS::CallArgs args = JS::CallArgsFromVp(argc, vp);
     JS::RootedObject obj(cx, args.thisv().toObjectOrNull());
     JS::CallReceiver rec = JS::CallReceiverFromVp(vp);
     if(argc == 1) {
-        // key
+        // key or key atom
         bool ok = true;
-        std::string key;
+        std::string keyBuffer;
+        const char *key = NULL;
         JS::RootedValue arg0Val(cx, args.get(0));
-        ok &= jsval_to_std_string(cx, arg0Val, &key);
-        if(firebase::remote_config::GetBoolean(key.c_str())) {
+        ok &= jsval_to_admob_key(cx, arg0Val, &keyBuffer, &key);
+        if(!ok) {
+            JS_ReportError(cx, "Invalid key");
+            return false;
+        }
+        bool value = false;
+        ADMOB_SDK_CALL(kSlotConfig, "remote_config::GetBoolean", key, value = firebase::remote_config::GetBoolean(key));
+        if(value) {
             rec.rval().set(JSVAL_TRUE);
         } else {
             rec.rval().set(JSVAL_FALSE);
@@ -167,17 +440,1005 @@ static bool jsb_admob_get_boolean(JSContext *cx, uint32_t argc, jsval *vp)
 static bool jsb_admob_get_integer(JSContext *cx, uint32_t argc, jsval *vp)
 {
     printLog("jsb_admob_get_integer");
+    ADMOB_TRACE(kTraceJsEntry, kSlotConfig, "jsb_admob_get_integer");
+    JS::CallArgs args = JS::CallArgsFromVp(argc, vp);
+    JS::RootedObject obj(cx, args.thisv().toObjectOrNull());
+    JS::CallReceiver rec = JS::CallReceiverFromVp(vp);
+    if(argc == 1) {
+        // key or key atom; null before admob.init has set Remote Config up
+        bool ok = true;
+        std::string keyBuffer;
+        const char *key = NULL;
+        JS::RootedValue arg0Val(cx, args.get(0));
+        ok &= jsval_to_admob_key(cx, arg0Val, &keyBuffer, &key);
+        if(!ok) {
+            JS_ReportError(cx, "Invalid key");
+            return false;
+        }
+        if(!remoteConfigReady) {
+            rec.rval().set(JSVAL_NULL);
+            return true;
+        }
+        int64_t value = 0;
+        ADMOB_SDK_CALL(kSlotConfig, "remote_config::GetLong", key, value = firebase::remote_config::GetLong(key));
+        rec.rval().set(int64_to_jsval(value));
+        return true;
+    } else {
+        JS_ReportError(cx, "Invalid number of arguments");
+        return false;
+    }
+}
+
+static bool jsb_admob_get_integers(JSContext *cx, uint32_t argc, jsval *vp)
+{
+    printLog("jsb_admob_get_integers");
+    ADMOB_TRACE(kTraceJsEntry, kSlotConfig, "jsb_admob_get_integers");
+    JS::CallArgs args = JS::CallArgsFromVp(argc, vp);
+    JS::RootedObject obj(cx, args.thisv().toObjectOrNull());
+    JS::CallReceiver rec = JS::CallReceiverFromVp(vp);
+    if(argc == 1 || argc == 2) {
+        // array of keys or key atoms, optional Float64Array to fill; null,
+        // with the array untouched, before Remote Config is set up
+        JS::RootedValue arg0Val(cx, args.get(0));
+        JS::RootedObject keys(cx, arg0Val.isObject() ? &arg0Val.toObject() : NULL);
+        uint32_t count = 0;
+        if(!keys || !JS_IsArrayObject(cx, keys) || !JS_GetArrayLength(cx, keys, &count)) {
+            JS_ReportError(cx, "Invalid keys");
+            return false;
+        }
+        if(!remoteConfigReady) {
+            rec.rval().set(JSVAL_NULL);
+            return true;
+        }
+        JS::RootedObject result(cx);
+        if(argc == 2) {
+            JS::RootedValue arg1Val(cx, args.get(1));
+            if(!arg1Val.isObject() || !JS_IsFloat64Array(&arg1Val.toObject()) ||
+               JS_GetTypedArrayLength(&arg1Val.toObject()) < count) {
+                JS_ReportError(cx, "Invalid result array");
+                return false;
+            }
+            result = &arg1Val.toObject();
+        } else {
+            result = JS_NewFloat64Array(cx, count);
+            if(!result) {
+                return false;
+            }
+        }
+        // values above 2^53 lose precision, as any JS number would
+        std::vector<double> values(count);
+        std::string keyBuffer;
+        JS::RootedValue keyVal(cx);
+        for(uint32_t i = 0; i < count; i++) {
+            const char *key = NULL;
+            if(!JS_GetElement(cx, keys, i, &keyVal) || !jsval_to_admob_key(cx, keyVal, &keyBuffer, &key)) {
+                JS_ReportError(cx, "Invalid key");
+                return false;
+            }
+            int64_t value = 0;
+            ADMOB_SDK_CALL(kSlotConfig, "remote_config::GetLong", key, value = firebase::remote_config::GetLong(key));
+            values[i] = (double)value;
+        }
+        // key getters run script, which may have detached the array; check
+        // it again, with no GC between taking the data pointer and the copy
+        if(count > 0) {
+            double *data = JS_GetTypedArrayLength(result) >= count ? JS_GetFloat64ArrayData(result) : NULL;
+            if(data == NULL) {
+                JS_ReportError(cx, "Invalid result array");
+                return false;
+            }
+            memcpy(data, values.data(), count * sizeof(double));
+        }
+        rec.rval().set(OBJECT_TO_JSVAL(result));
+        return true;
+    } else {
+        JS_ReportError(cx, "Invalid number of arguments");
+        return false;
+    }
+}
+
+static bool jsb_admob_get_double(JSContext *cx, uint32_t argc, jsval *vp)
+{
+    printLog("jsb_admob_get_double");
+    ADMOB_TRACE(kTraceJsEntry, kSlotConfig, "jsb_admob_get_double");
+    JS::CallArgs args = JS::CallArgsFromVp(argc, vp);
+    JS::RootedObject obj(cx, args.thisv().toObjectOrNull());
+    JS::CallReceiver rec = JS::CallReceiverFromVp(vp);
+    if(argc == 1) {
+        // key or key atom
+        bool ok = true;
+        std::string keyBuffer;
+        const char *key = NULL;
+        JS::RootedValue arg0Val(cx, args.get(0));
+        ok &= jsval_to_admob_key(cx, arg0Val, &keyBuffer, &key);
+        if(!ok) {
+            JS_ReportError(cx, "Invalid key");
+            return false;
+        }
+        double value = 0;
+        ADMOB_SDK_CALL(kSlotConfig, "remote_config::GetDouble", key, value = firebase::remote_config::GetDouble(key));
+        rec.rval().set(JS::DoubleValue(value));
+        return true;
+    } else {
+        JS_ReportError(cx, "Invalid number of arguments");
+        return false;
+    }
+}
+
+static bool jsb_admob_get_string(JSContext *cx, uint32_t argc, jsval *vp)
+{
+    printLog("jsb_admob_get_string");
+    ADMOB_TRACE(kTraceJsEntry, kSlotConfig, "jsb_admob_get_string");
+    JS::CallArgs args = JS::CallArgsFromVp(argc, vp);
+    JS::RootedObject obj(cx, args.thisv().toObjectOrNull());
+    JS::CallReceiver rec = JS::CallReceiverFromVp(vp);
+    if(argc == 1) {
+        // key or key atom
+        bool ok = true;
+        std::string keyBuffer;
+        const char *key = NULL;
+        JS::RootedValue arg0Val(cx, args.get(0));
+        ok &= jsval_to_admob_key(cx, arg0Val, &keyBuffer, &key);
+        if(!ok) {
+            JS_ReportError(cx, "Invalid key");
+            return false;
+        }
+        std::string value;
+        ADMOB_SDK_CALL(kSlotConfig, "remote_config::GetString", key, value = firebase::remote_config::GetString(key));
+        rec.rval().set(std_string_to_jsval(cx, value));
+        return true;
+    } else {
+        JS_ReportError(cx, "Invalid number of arguments");
+        return false;
+    }
+}
+
+static bool jsb_admob_get_data(JSContext *cx, uint32_t argc, jsval *vp)
+{
+    printLog("jsb_admob_get_data");
+    ADMOB_TRACE(kTraceJsEntry, kSlotConfig, "jsb_admob_get_data");
+    JS::CallArgs args = JS::CallArgsFromVp(argc, vp);
+    JS::RootedObject obj(cx, args.thisv().toObjectOrNull());
+    JS::CallReceiver rec = JS::CallReceiverFromVp(vp);
+    if(argc == 1) {
+        // key or key atom; returns a new ArrayBuffer, or null when unset or
+        // before admob.init has set Remote Config up
+        bool ok = true;
+        std::string keyBuffer;
+        const char *key = NULL;
+        JS::RootedValue arg0Val(cx, args.get(0));
+        ok &= jsval_to_admob_key(cx, arg0Val, &keyBuffer, &key);
+        if(!ok) {
+            JS_ReportError(cx, "Invalid key");
+            return false;
+        }
+        if(!remoteConfigReady) {
+            rec.rval().set(JSVAL_NULL);
+            return true;
+        }
+        // one copy from the SDK's vector into a buffer JS owns alone
+        std::vector<unsigned char> value;
+        ADMOB_SDK_CALL(kSlotConfig, "remote_config::GetData", key, value = firebase::remote_config::GetData(key));
+        if(value.empty()) {
+            rec.rval().set(JSVAL_NULL);
+            return true;
+        }
+        JS::RootedObject buffer(cx, JS_NewArrayBuffer(cx, value.size()));
+        if(!buffer) {
+            return false;
+        }
+        memcpy(JS_GetArrayBufferData(buffer), value.data(), value.size());
+        rec.rval().set(OBJECT_TO_JSVAL(buffer));
+        return true;
+    } else {
+        JS_ReportError(cx, "Invalid number of arguments");
+        return false;
+    }
+}
+
+///////////////////////////////////////
+//
+//  Ad Listeners
+//
+///////////////////////////////////////
+
+// Long-lived JS handlers registered once with admob.register_handler and
+// passed to load_* / show_* by handle instead of a callback function, so a
+// load or show neither allocates nor roots anything. The roots are created
+// at registration and live until the handler is unregistered.
+static const int kHandlerCount = 64;
+
+struct JsHandler {
+    JSContext *cx;
+    JS::PersistentRootedObject *global;
+    JS::PersistentRootedValue *func;
+    JS::PersistentRootedValue *thisVal;
+    uint32_t generation;
+};
+
+static JsHandler jsHandlers[kHandlerCount] = {};
+
+// A handle is the table index plus the slot generation, so a handle kept
+// after unregister_handler never reaches a handler registered later.
+static int handlerHandle(int index) {
+    return (int)((jsHandlers[index].generation << 8) | (uint32_t)index);
+}
+
+static JsHandler *lookupHandler(int handle) {
+    int index = handle & 0xff;
+    if(handle < 0 || index >= kHandlerCount || jsHandlers[index].func == NULL ||
+       handlerHandle(index) != handle) {
+        return NULL;
+    }
+    return &jsHandlers[index];
+}
+
+static int registerHandler(JSContext *cx, JS::HandleValue func, JS::HandleValue thisVal) {
+    for(int i = 0; i < kHandlerCount; i++) {
+        JsHandler &h = jsHandlers[i];
+        if(h.func == NULL) {
+            h.cx = cx;
+            h.global = new JS::PersistentRootedObject(cx, JS::CurrentGlobalOrNull(cx));
+            h.func = new JS::PersistentRootedValue(cx, func);
+            h.thisVal = new JS::PersistentRootedValue(cx, thisVal);
+            return handlerHandle(i);
+        }
+    }
+    return -1;
+}
+
+// With contextAlive false the roots belong to a destroyed runtime and are
+// forgotten rather than freed.
+static void releaseHandler(JsHandler *h, bool contextAlive) {
+    if(contextAlive) {
+        delete h->global;
+        delete h->func;
+        delete h->thisVal;
+    }
+    h->cx = NULL;
+    h->global = NULL;
+    h->func = NULL;
+    h->thisVal = NULL;
+    h->generation = (h->generation + 1) & 0x7fffff;
+}
+
+// Calls a registered handler; `fill` appends the arguments. Unknown or
+// unregistered handles are ignored.
+template<typename Fill>
+static void callJsHandler(int handle, const Fill &fill)
+{
+    JsHandler *h = lookupHandler(handle);
+    if(h == NULL) {
+        return;
+    }
+    JSContext *cx = h->cx;
+    JSAutoRequest rq(cx);
+    JSAutoCompartment ac(cx, *h->global);
+    // local roots, the handler may unregister itself while it runs
+    JS::RootedValue func(cx, *h->func);
+    JS::RootedObject thisObj(cx, h->thisVal->isObject() ? &h->thisVal->toObject() : NULL);
+    JS::AutoValueVector valArr(cx);
+    fill(cx, valArr);
+    JS::HandleValueArray funcArgs = JS::HandleValueArray::fromMarkedLocation(valArr.length(), valArr.begin());
+    JS::RootedValue rval(cx);
+    if(!JS_CallFunctionValue(cx, thisObj, func, funcArgs, &rval)) {
+        JS_ReportPendingException(cx);
+    }
+}
+
+// The JS callback of the latest show_* call per slot (cocos thread only),
+// either a callback frame or a registered handler handle (-1 when none).
+// The core keeps one listener per ad object for the whole session, so nothing
+// is allocated per show and late SDK events never reach a freed callback.
+static CallbackFrame *adSubscribers[sdkbar::admob::kSlotConfig] = {};
+static int adSubscriberHandlers[sdkbar::admob::kSlotConfig] = { -1, -1, -1, -1 };
+static std::vector<CallbackFrame*> retiredSubscribers;
+static int adDispatchDepth = 0;
+
+// Pending load callbacks remember the epoch they were created in. Scene
+// teardown (admob.invalidate_callbacks) and a JS VM reload bump the epoch in
+// O(1); stale callbacks are then dropped when their result is drained instead
+// of calling into a dead scene or context.
+static uint32_t callbackEpoch = 0;
+// First epoch of the current JS context. Frames from older epochs belong to a
+// destroyed context and are abandoned rather than freed.
+static uint32_t contextEpoch = 0;
+
+// Frees a subscriber frame. While a subscriber call is on the stack the frame
+// may be the one being called (replaced from inside its own callback), so it
+// is freed once the call returns.
+static void retireSubscriber(CallbackFrame *cb)
+{
+    if(cb == NULL) {
+        return;
+    }
+    if(adDispatchDepth > 0) {
+        retiredSubscribers.push_back(cb);
+    } else {
+        delete cb;
+    }
+}
+
+// Calls a subscriber frame, see retireSubscriber.
+static void callSubscriber(CallbackFrame *cb, const JS::HandleValueArray &funcArgs)
+{
+    adDispatchDepth++;
+    cb->call(funcArgs);
+    adDispatchDepth--;
+    if(adDispatchDepth == 0 && !retiredSubscribers.empty()) {
+        for(size_t i = 0; i < retiredSubscribers.size(); i++) {
+            delete retiredSubscribers[i];
+        }
+        retiredSubscribers.clear();
+    }
+}
+
+static void setAdSubscriber(sdkbar::admob::TraceSlot slot, CallbackFrame *cb, int handler = -1)
+{
+    adSubscriberHandlers[slot] = handler;
+    retireSubscriber(adSubscribers[slot]);
+    adSubscribers[slot] = cb;
+}
+
+// Optional Float64Array the ad events are written into instead of being passed
+// as separate arguments (admob.set_event_buffer). The same rooted view is
+// reused for every event, so event bursts create no JS values at all.
+// Layout: format, event type (0 state, 1 reward), state (3 for a reward),
+// reward amount, reward type atom.
+static const uint32_t kEventBufferLength = 5;
+static JS::PersistentRootedObject *eventBuffer = NULL;
+
+// Receives the live-ops diffs, see live_ops_subscribe.
+static CallbackFrame *liveOpsSubscriber = NULL;
+
+// The fetch_bundle ArrayBuffers not yet returned with release_bundle, which
+// accepts nothing else: it must never detach a get_data copy or the event
+// buffer. They are matched by object, held weakly: a bundle dropped without
+// a release is freed by the GC and its entry swept after that GC.
+struct LiveBundle {
+    JS::Heap<JSObject*> object;
+};
+static std::vector<LiveBundle> *liveBundles = NULL;
+// Runtime the sweep is registered with.
+static JSRuntime *liveBundlesRuntime = NULL;
+
+static void sweepLiveBundles(JSRuntime *rt, void *data)
+{
+    if(liveBundles == NULL) {
+        return;
+    }
+    for(size_t i = 0; i < liveBundles->size();) {
+        JS_UpdateWeakPointerAfterGC(&(*liveBundles)[i].object);
+        if((*liveBundles)[i].object.get() == NULL) {
+            (*liveBundles)[i] = liveBundles->back();
+            liveBundles->pop_back();
+        } else {
+            i++;
+        }
+    }
+}
+
+static void addLiveBundle(JSContext *cx, JSObject *buffer)
+{
+    JSRuntime *rt = JS_GetRuntime(cx);
+    if(liveBundlesRuntime != rt) {
+        liveBundles = new std::vector<LiveBundle>();
+        liveBundlesRuntime = rt;
+        JS_AddWeakPointerCallback(rt, sweepLiveBundles, NULL);
+    }
+    liveBundles->push_back(LiveBundle());
+    liveBundles->back().object = buffer;
+}
+
+// Index of buffer in liveBundles, or -1.
+static int findLiveBundle(JSObject *buffer)
+{
+    if(liveBundles == NULL) {
+        return -1;
+    }
+    for(size_t i = 0; i < liveBundles->size(); i++) {
+        if((*liveBundles)[i].object.get() == buffer) {
+            return (int)i;
+        }
+    }
+    return -1;
+}
+
+// Drops every JS callback the plugin holds. With contextAlive false the old
+// context is already gone, so its frames and roots are forgotten, not freed.
+static void invalidateCallbacks(bool contextAlive)
+{
+    callbackEpoch++;
+    if(!contextAlive) {
+        contextEpoch = callbackEpoch;
+        for(int slot = 0; slot < sdkbar::admob::kSlotConfig; slot++) {
+            adSubscribers[slot] = NULL;
+            adSubscriberHandlers[slot] = -1;
+        }
+        retiredSubscribers.clear();
+        eventBuffer = NULL;
+        liveOpsSubscriber = NULL;
+        // the runtime died with the context; its heap pointers are forgotten
+        // and a new list starts with the next runtime
+        liveBundles = NULL;
+        liveBundlesRuntime = NULL;
+    } else {
+        for(int slot = 0; slot < sdkbar::admob::kSlotConfig; slot++) {
+            setAdSubscriber((sdkbar::admob::TraceSlot)slot, NULL);
+        }
+        delete eventBuffer;
+        eventBuffer = NULL;
+        retireSubscriber(liveOpsSubscriber);
+        liveOpsSubscriber = NULL;
+    }
+    for(int i = 0; i < kHandlerCount; i++) {
+        if(jsHandlers[i].func != NULL) {
+            releaseHandler(&jsHandlers[i], contextAlive);
+        }
+    }
+}
+
+// Invokes the current JS subscriber of the slot, cocos thread only.
+// `fill` appends the event arguments.
+template<typename Fill>
+static void callAdSubscriber(sdkbar::admob::TraceSlot slot, const Fill &fill)
+{
+    if(adSubscriberHandlers[slot] >= 0) {
+        callJsHandler(adSubscriberHandlers[slot], fill);
+        return;
+    }
+    CallbackFrame *cb = adSubscribers[slot];
+    if(cb == NULL) {
+        return;
+    }
+    JSAutoRequest rq(cb->cx);
+    JSAutoCompartment ac(cb->cx, cb->_ctxObject.ref());
+    JS::AutoValueVector valArr(cb->cx);
+    fill(cb->cx, valArr);
+    JS::HandleValueArray funcArgs = JS::HandleValueArray::fromMarkedLocation(valArr.length(), valArr.begin());
+    callSubscriber(cb, funcArgs);
+}
+
+// Appends the argument form of an event: (presentation state) or, for
+// rewards, (3, amount, reward type atom).
+static void appendAdEventArgs(JSContext *cx, const sdkbar::admob::AdEvent &event, JS::AutoValueVector &valArr)
+{
+    if(event.type == sdkbar::admob::kAdEventReward) {
+        valArr.append(int32_to_jsval(cx, 3));
+        valArr.append(JS::DoubleValue(event.rewardAmount));
+        valArr.append(JS::Int32Value(event.rewardTypeAtom));
+    } else {
+        valArr.append(int32_to_jsval(cx, event.presentationState));
+    }
+}
+
+// Forwards core ad events to the slot's JS subscriber as arguments, see
+// appendAdEventArgs. JS resolves the atom with admob.atom_string() and
+// caches it. With an event buffer set the subscriber gets (buffer) instead,
+// unless the buffer was detached or shrunk since set_event_buffer.
+static void onAdEvent(const sdkbar::admob::AdEvent &event)
+{
+    sdkbar::admob::TraceSlot slot = (sdkbar::admob::TraceSlot)event.format;
+    if(eventBuffer != NULL) {
+        callAdSubscriber(slot, [&event](JSContext *cx, JS::AutoValueVector &valArr) {
+                // no GC between taking the data pointer and the writes
+                double *fields = NULL;
+                if(eventBuffer != NULL && JS_GetTypedArrayLength(*eventBuffer) >= kEventBufferLength) {
+                    fields = JS_GetFloat64ArrayData(*eventBuffer);
+                }
+                if(fields == NULL) {
+                    appendAdEventArgs(cx, event, valArr);
+                    return;
+                }
+                bool reward = event.type == sdkbar::admob::kAdEventReward;
+                fields[0] = event.format;
+                fields[1] = event.type;
+                fields[2] = reward ? 3 : event.presentationState;
+                fields[3] = reward ? event.rewardAmount : 0;
+                fields[4] = reward ? event.rewardTypeAtom : -1;
+                valArr.append(OBJECT_TO_JSVAL(*eventBuffer));
+            });
+    } else {
+        callAdSubscriber(slot, [&event](JSContext *cx, JS::AutoValueVector &valArr) {
+                appendAdEventArgs(cx, event, valArr);
+            });
+    }
+}
+
+///////////////////////////////////////
+//
+//  Show Arbiter
+//
+///////////////////////////////////////
+
+static uint64_t arbiterNowMs() {
+    return sdkbar::admob::traceNow() / 1000;
+}
+
+// Pacing rule keys: <prefix>{session_cap,cooldown,daily_cap,burst_cap,burst_window}.
+// Missing keys read as 0, i.e. no limit. Without Remote Config (e.g. no Play
+// Services) the scope keeps its current rule.
+static void loadPacingRule(int scope, const char *name, const std::string &prefix) {
+    if(!remoteConfigReady) {
+        return;
+    }
+    const char *keys[] = { "session_cap", "cooldown", "daily_cap", "burst_cap", "burst_window" };
+    int64_t values[5] = { 0 };
+    for(int i = 0; i < 5; i++) {
+        ADMOB_SDK_CALL(kSlotConfig, "remote_config::GetLong", name, values[i] = firebase::remote_config::GetLong((prefix + keys[i]).c_str()));
+        values[i] = values[i] > 0 ? values[i] : 0;
+    }
+    sdkbar::admob::PacingRule rule;
+    rule.sessionCap = (uint32_t)values[0];
+    rule.minIntervalSec = (uint32_t)values[1];
+    rule.dailyCap = (uint32_t)values[2];
+    rule.burstCap = values[3] > sdkbar::admob::kPacingRing ? sdkbar::admob::kPacingRing : (uint32_t)values[3];
+    rule.burstWindowSec = (uint32_t)values[4];
+    sdkbar::admob::setPacingRule(scope, rule);
+}
+
+// Reads admob_<placement>_{ecpm_interstitial,ecpm_rewarded} and the pacing
+// keys from Remote Config. Until admob.init has set Remote Config up the
+// hints stay 0; reloadPlacementHints() reads them then.
+static void loadPlacementHints(int placement, const char *name) {
+    if(!remoteConfigReady) {
+        return;
+    }
+    std::string prefix = std::string("admob_") + name + "_";
+    double interstitialFloor = 0;
+    double rewardedFloor = 0;
+    ADMOB_SDK_CALL(kSlotConfig, "remote_config::GetDouble", name, interstitialFloor = firebase::remote_config::GetDouble((prefix + "ecpm_interstitial").c_str()));
+    ADMOB_SDK_CALL(kSlotConfig, "remote_config::GetDouble", name, rewardedFloor = firebase::remote_config::GetDouble((prefix + "ecpm_rewarded").c_str()));
+    sdkbar::admob::setPlacementFloor(placement, sdkbar::admob::kAdInterstitial, (float)interstitialFloor);
+    sdkbar::admob::setPlacementFloor(placement, sdkbar::admob::kAdRewarded, (float)rewardedFloor);
+    loadPacingRule(placement, name, prefix);
+}
+
+static void reloadPlacementHints() {
+    for(int placement = 0; sdkbar::admob::placementName(placement) >= 0; placement++) {
+        loadPlacementHints(placement, sdkbar::admob::atomString(sdkbar::admob::placementName(placement)));
+    }
+}
+
+// Daily caps persist in the writable path; the global rule comes from
+// admob_global_* Remote Config keys.
+static void initPacing() {
+    sdkbar::admob::attachPacingScope(sdkbar::admob::kPacingGlobal, "*");
+    sdkbar::admob::setPacingStore(cocos2d::FileUtils::getInstance()->getWritablePath() + "admob_pacing.txt");
+    loadPacingRule(sdkbar::admob::kPacingGlobal, "global", "admob_global_");
+}
+
+static bool jsb_admob_define_placement(JSContext *cx, uint32_t argc, jsval *vp)
+{
+    printLog("jsb_admob_define_placement");
+    ADMOB_TRACE(kTraceJsEntry, kSlotNone, "jsb_admob_define_placement");
+    JS::CallArgs args = JS::CallArgsFromVp(argc, vp);
+    JS::RootedObject obj(cx, args.thisv().toObjectOrNull());
+    JS::CallReceiver rec = JS::CallReceiverFromVp(vp);
+    if(argc == 2) {
+        // placement name or atom, kind mask (2 interstitial, 4 rewarded)
+        bool ok = true;
+        int nameAtom = -1;
+        uint32_t kindMask = 0;
+        JS::RootedValue arg0Val(cx, args.get(0));
+        JS::RootedValue arg1Val(cx, args.get(1));
+        if(arg0Val.isInt32()) {
+            nameAtom = arg0Val.toInt32();
+        } else {
+            std::string name;
+            ok &= jsval_to_std_string(cx, arg0Val, &name);
+            nameAtom = ok ? sdkbar::admob::internString(name) : -1;
+        }
+        ok &= jsval_to_uint32(cx, arg1Val, &kindMask);
+        if(!ok || sdkbar::admob::atomString(nameAtom) == NULL) {
+            JS_ReportError(cx, "Invalid placement");
+            return false;
+        }
+        int placement = sdkbar::admob::definePlacement(nameAtom, kindMask);
+        if(placement < 0) {
+            JS_ReportError(cx, "Too many placements");
+            return false;
+        }
+        // Remote Config hints; set_placement_hints overrides them
+        loadPlacementHints(placement, sdkbar::admob::atomString(nameAtom));
+        rec.rval().set(JS::Int32Value(placement));
+        return true;
+    } else {
+        JS_ReportError(cx, "Invalid number of arguments");
+        return false;
+    }
+}
+
+static bool jsb_admob_set_placement_hints(JSContext *cx, uint32_t argc, jsval *vp)
+{
+    printLog("jsb_admob_set_placement_hints");
+    JS::CallArgs args = JS::CallArgsFromVp(argc, vp);
+    JS::RootedObject obj(cx, args.thisv().toObjectOrNull());
+    JS::CallReceiver rec = JS::CallReceiverFromVp(vp);
+    if(argc == 5) {
+        // placement id, interstitial eCPM floor, rewarded eCPM floor, cooldown seconds, session cap
+        bool ok = true;
+        int32_t placement = -1;
+        double interstitialFloor = 0;
+        double rewardedFloor = 0;
+        uint32_t cooldown = 0;
+        uint32_t sessionCap = 0;
+        JS::RootedValue arg0Val(cx, args.get(0));
+        JS::RootedValue arg1Val(cx, args.get(1));
+        JS::RootedValue arg2Val(cx, args.get(2));
+        JS::RootedValue arg3Val(cx, args.get(3));
+        JS::RootedValue arg4Val(cx, args.get(4));
+        ok &= jsval_to_int32(cx, arg0Val, &placement);
+        ok &= JS::ToNumber(cx, arg1Val, &interstitialFloor);
+        ok &= JS::ToNumber(cx, arg2Val, &rewardedFloor);
+        ok &= jsval_to_uint32(cx, arg3Val, &cooldown);
+        ok &= jsval_to_uint32(cx, arg4Val, &sessionCap);
+        if(!ok || sdkbar::admob::placementName(placement) < 0) {
+            JS_ReportError(cx, "Invalid placement hints");
+            return false;
+        }
+        sdkbar::admob::setPlacementFloor(placement, sdkbar::admob::kAdInterstitial, (float)interstitialFloor);
+        sdkbar::admob::setPlacementFloor(placement, sdkbar::admob::kAdRewarded, (float)rewardedFloor);
+        sdkbar::admob::PacingRule rule = sdkbar::admob::pacingRule(placement);
+        rule.minIntervalSec = cooldown;
+        rule.sessionCap = sessionCap;
+        sdkbar::admob::setPacingRule(placement, rule);
+        rec.rval().set(JSVAL_TRUE);
+        return true;
+    } else {
+        JS_ReportError(cx, "Invalid number of arguments");
+        return false;
+    }
+}
+
+static bool jsb_admob_set_pacing_rule(JSContext *cx, uint32_t argc, jsval *vp)
+{
+    printLog("jsb_admob_set_pacing_rule");
+    JS::CallArgs args = JS::CallArgsFromVp(argc, vp);
+    JS::RootedObject obj(cx, args.thisv().toObjectOrNull());
+    JS::CallReceiver rec = JS::CallReceiverFromVp(vp);
+    if(argc == 6) {
+        // placement id or -1 for global, session cap, min seconds between shows,
+        // daily cap, burst cap, burst window seconds; 0 disables a limit
+        bool ok = true;
+        int32_t scope = 0;
+        sdkbar::admob::PacingRule rule;
+        JS::RootedValue arg0Val(cx, args.get(0));
+        JS::RootedValue arg1Val(cx, args.get(1));
+        JS::RootedValue arg2Val(cx, args.get(2));
+        JS::RootedValue arg3Val(cx, args.get(3));
+        JS::RootedValue arg4Val(cx, args.get(4));
+        JS::RootedValue arg5Val(cx, args.get(5));
+        ok &= jsval_to_int32(cx, arg0Val, &scope);
+        ok &= jsval_to_uint32(cx, arg1Val, &rule.sessionCap);
+        ok &= jsval_to_uint32(cx, arg2Val, &rule.minIntervalSec);
+        ok &= jsval_to_uint32(cx, arg3Val, &rule.dailyCap);
+        ok &= jsval_to_uint32(cx, arg4Val, &rule.burstCap);
+        ok &= jsval_to_uint32(cx, arg5Val, &rule.burstWindowSec);
+        if(!ok || (scope != sdkbar::admob::kPacingGlobal && sdkbar::admob::placementName(scope) < 0) ||
+           !sdkbar::admob::setPacingRule(scope, rule)) {
+            JS_ReportError(cx, "Invalid pacing rule");
+            return false;
+        }
+        rec.rval().set(JSVAL_TRUE);
+        return true;
+    } else {
+        JS_ReportError(cx, "Invalid number of arguments");
+        return false;
+    }
+}
+
+static bool jsb_admob_best_ad(JSContext *cx, uint32_t argc, jsval *vp)
+{
+    ADMOB_TRACE(kTraceJsEntry, kSlotNone, "jsb_admob_best_ad");
+    JS::CallArgs args = JS::CallArgsFromVp(argc, vp);
+    JS::RootedObject obj(cx, args.thisv().toObjectOrNull());
+    JS::CallReceiver rec = JS::CallReceiverFromVp(vp);
+    if(argc == 1) {
+        // placement id; returns 0 none, 1 interstitial, 2 rewarded
+        bool ok = true;
+        int32_t placement = -1;
+        JS::RootedValue arg0Val(cx, args.get(0));
+        ok &= jsval_to_int32(cx, arg0Val, &placement);
+        if(!ok) {
+            JS_ReportError(cx, "Invalid placement");
+            return false;
+        }
+        rec.rval().set(JS::Int32Value(sdkbar::admob::bestAd(placement, arbiterNowMs())));
+        return true;
+    } else {
+        JS_ReportError(cx, "Invalid number of arguments");
+        return false;
+    }
+}
+
+///////////////////////////////////////
+//
+//  Telemetry
+//
+///////////////////////////////////////
+
+static bool jsb_admob_read_telemetry(JSContext *cx, uint32_t argc, jsval *vp)
+{
+    printLog("jsb_admob_read_telemetry");
+    JS::CallArgs args = JS::CallArgsFromVp(argc, vp);
+    JS::RootedObject obj(cx, args.thisv().toObjectOrNull());
+    JS::CallReceiver rec = JS::CallReceiverFromVp(vp);
+    if(argc == 1) {
+        // max records; returns an ArrayBuffer of 32-byte records, oldest first,
+        // or null when nothing is pending. See SpoolRecord for the layout.
+        bool ok = true;
+        uint32_t max = 0;
+        JS::RootedValue arg0Val(cx, args.get(0));
+        ok &= jsval_to_uint32(cx, arg0Val, &max);
+        if(!ok) {
+            JS_ReportError(cx, "Invalid count");
+            return false;
+        }
+        size_t count = sdkbar::admob::spoolPending();
+        count = count < max ? count : max;
+        if(count == 0) {
+            rec.rval().set(JSVAL_NULL);
+            return true;
+        }
+        JS::RootedObject buffer(cx, JS_NewArrayBuffer(cx, count * sizeof(sdkbar::admob::SpoolRecord)));
+        if(!buffer) {
+            return false;
+        }
+        // records are read straight into the buffer; no GC in between
+        sdkbar::admob::readSpool(reinterpret_cast<sdkbar::admob::SpoolRecord*>(JS_GetArrayBufferData(buffer)), count);
+        rec.rval().set(OBJECT_TO_JSVAL(buffer));
+        return true;
+    } else {
+        JS_ReportError(cx, "Invalid number of arguments");
+        return false;
+    }
+}
+
+static bool jsb_admob_ack_telemetry(JSContext *cx, uint32_t argc, jsval *vp)
+{
+    printLog("jsb_admob_ack_telemetry");
+    JS::CallArgs args = JS::CallArgsFromVp(argc, vp);
+    JS::RootedObject obj(cx, args.thisv().toObjectOrNull());
+    JS::CallReceiver rec = JS::CallReceiverFromVp(vp);
+    if(argc == 1) {
+        // number of records from the last read_telemetry that were uploaded
+        bool ok = true;
+        uint32_t count = 0;
+        JS::RootedValue arg0Val(cx, args.get(0));
+        ok &= jsval_to_uint32(cx, arg0Val, &count);
+        if(!ok) {
+            JS_ReportError(cx, "Invalid count");
+            return false;
+        }
+        sdkbar::admob::ackSpool(count);
+        rec.rval().set(JS::Int32Value((int32_t)sdkbar::admob::spoolPending()));
+        return true;
+    } else {
+        JS_ReportError(cx, "Invalid number of arguments");
+        return false;
+    }
+}
+
+///////////////////////////////////////
+//
+//  Live Ops
+//
+///////////////////////////////////////
+
+// Passes one coalesced diff to JS: (changed children as key: value, removed
+// keys, connected).
+static void onLiveOpsDiff(const sdkbar::admob::LiveOpsTree &changed, const std::vector<std::string> &removed, bool connected)
+{
+    CallbackFrame *cb = liveOpsSubscriber;
+    if(cb == NULL) {
+        return;
+    }
+    JSContext *cx = cb->cx;
+    JSAutoRequest rq(cx);
+    JSAutoCompartment ac(cx, cb->_ctxObject.ref());
+    JS::RootedObject changes(cx, JS_NewObject(cx, NULL, JS::NullPtr(), JS::NullPtr()));
+    JS::RootedObject removals(cx, JS_NewArrayObject(cx, removed.size()));
+    if(!changes || !removals) {
+        return;
+    }
+    JS::RootedValue value(cx);
+    for(sdkbar::admob::LiveOpsTree::const_iterator it = changed.begin(); it != changed.end(); ++it) {
+        if(!sdkbar::admob::variantToJsval(cx, it->second, &value) ||
+           !sdkbar::admob::defineUtf8Property(cx, changes, it->first.c_str(), value)) {
+            JS_ReportPendingException(cx);
+            return;
+        }
+    }
+    for(size_t i = 0; i < removed.size(); i++) {
+        value = std_string_to_jsval(cx, removed[i]);
+        if(!JS_DefineElement(cx, removals, (uint32_t)i, value, JSPROP_ENUMERATE)) {
+            JS_ReportPendingException(cx);
+            return;
+        }
+    }
+    JS::AutoValueVector valArr(cx);
+    valArr.append(OBJECT_TO_JSVAL(changes));
+    valArr.append(OBJECT_TO_JSVAL(removals));
+    valArr.append(connected ? JSVAL_TRUE : JSVAL_FALSE);
+    JS::HandleValueArray funcArgs = JS::HandleValueArray::fromMarkedLocation(valArr.length(), valArr.begin());
+    // the callback may unsubscribe, resubscribe or invalidate callbacks
+    callSubscriber(cb, funcArgs);
+}
+
+static bool jsb_admob_live_ops_subscribe(JSContext *cx, uint32_t argc, jsval *vp)
+{
+    printLog("jsb_admob_live_ops_subscribe");
+    JS::CallArgs args = JS::CallArgsFromVp(argc, vp);
+    JS::RootedObject obj(cx, args.thisv().toObjectOrNull());
+    JS::CallReceiver rec = JS::CallReceiverFromVp(vp);
+    if(argc == 3) {
+        // Realtime Database path, callback, this; false when the module is
+        // not built in or Firebase is not initialized
+        bool ok = true;
+        std::string path;
+        JS::RootedValue arg0Val(cx, args.get(0));
+        ok &= jsval_to_std_string(cx, arg0Val, &path);
+        if(!ok) {
+            JS_ReportError(cx, "Invalid path");
+            return false;
+        }
+        firebase::App *app = firebase::App::GetInstance();
+        CallbackFrame *cb = new CallbackFrame(cx, obj, args.get(2), args.get(1));
+        if(app != NULL && sdkbar::admob::startLiveOps(app, path.c_str(), onLiveOpsDiff)) {
+            retireSubscriber(liveOpsSubscriber);
+            liveOpsSubscriber = cb;
+            rec.rval().set(JSVAL_TRUE);
+        } else {
+            delete cb;
+            rec.rval().set(JSVAL_FALSE);
+        }
+        return true;
+    } else {
+        JS_ReportError(cx, "Invalid number of arguments");
+        return false;
+    }
+}
+
+static bool jsb_admob_live_ops_unsubscribe(JSContext *cx, uint32_t argc, jsval *vp)
+{
+    printLog("jsb_admob_live_ops_unsubscribe");
+    JS::CallArgs args = JS::CallArgsFromVp(argc, vp);
+    JS::RootedObject obj(cx, args.thisv().toObjectOrNull());
+    JS::CallReceiver rec = JS::CallReceiverFromVp(vp);
+    if(argc == 0) {
+        sdkbar::admob::stopLiveOps();
+        retireSubscriber(liveOpsSubscriber);
+        liveOpsSubscriber = NULL;
+        rec.rval().set(JSVAL_TRUE);
+        return true;
+    } else {
+        JS_ReportError(cx, "Invalid number of arguments");
+        return false;
+    }
+}
+
+static bool jsb_admob_live_ops_get(JSContext *cx, uint32_t argc, jsval *vp)
+{
+    JS::CallArgs args = JS::CallArgsFromVp(argc, vp);
+    JS::RootedObject obj(cx, args.thisv().toObjectOrNull());
+    JS::CallReceiver rec = JS::CallReceiverFromVp(vp);
+    if(argc == 1) {
+        // child key; its value as of the last diff, or undefined
+        bool ok = true;
+        std::string key;
+        JS::RootedValue arg0Val(cx, args.get(0));
+        ok &= jsval_to_std_string(cx, arg0Val, &key);
+        if(!ok) {
+            JS_ReportError(cx, "Invalid key");
+            return false;
+        }
+        const sdkbar::admob::LiveOpsTree &tree = sdkbar::admob::liveOpsTree();
+        sdkbar::admob::LiveOpsTree::const_iterator it = tree.find(key);
+        if(it == tree.end()) {
+            rec.rval().setUndefined();
+            return true;
+        }
+        JS::RootedValue value(cx);
+        if(!sdkbar::admob::variantToJsval(cx, it->second, &value)) {
+            return false;
+        }
+        rec.rval().set(value);
+        return true;
+    } else {
+        JS_ReportError(cx, "Invalid number of arguments");
+        return false;
+    }
+}
+
+///////////////////////////////////////
+//
+//  Bundles
+//
+///////////////////////////////////////
+
+// Calls the fetch_bundle callback once with (ArrayBuffer or null, error code)
+// and frees it. The ArrayBuffer adopts the pool buffer without a copy; it goes
+// back to the pool through release_bundle.
+static void callBundleCallback(int callbackId, uint32_t epoch, sdkbar::admob::BundleError error, void *data, size_t size)
+{
+    CallbackFrame *cb = CallbackFrame::getById(callbackId);
+    if(epoch != callbackEpoch) {
+        sdkbar::admob::releaseBundleBuffer(data);
+        if(epoch >= contextEpoch) {
+            delete cb;
+        }
+        return;
+    }
+    JSContext *cx = cb->cx;
+    JSAutoRequest rq(cx);
+    JSAutoCompartment ac(cx, cb->_ctxObject.ref());
+    JS::RootedObject buffer(cx);
+    if(data != NULL) {
+        buffer = JS_NewArrayBufferWithContents(cx, size, data);
+        if(!buffer) {
+            sdkbar::admob::releaseBundleBuffer(data);
+            error = sdkbar::admob::kBundleTooLarge;
+        } else {
+            addLiveBundle(cx, buffer);
+        }
+    }
+    JS::AutoValueVector valArr(cx);
+    valArr.append(buffer ? OBJECT_TO_JSVAL(buffer) : JSVAL_NULL);
+    valArr.append(INT_TO_JSVAL(error));
+    JS::HandleValueArray funcArgs = JS::HandleValueArray::fromMarkedLocation(valArr.length(), valArr.begin());
+    cb->call(funcArgs);
+    delete cb;
+}
+
+static bool jsb_admob_configure_bundles(JSContext *cx, uint32_t argc, jsval *vp)
+{
+    printLog("jsb_admob_configure_bundles");
+    JS::CallArgs args = JS::CallArgsFromVp(argc, vp);
+    JS::CallReceiver rec = JS::CallReceiverFromVp(vp);
+    if(argc == 2) {
+        // buffer count, bytes per buffer; only the first call takes effect
+        bool ok = true;
+        uint32_t slots = 0;
+        uint32_t slotBytes = 0;
+        JS::RootedValue arg0Val(cx, args.get(0));
+        JS::RootedValue arg1Val(cx, args.get(1));
+        ok &= jsval_to_uint32(cx, arg0Val, &slots);
+        ok &= jsval_to_uint32(cx, arg1Val, &slotBytes);
+        if(!ok) {
+            JS_ReportError(cx, "Invalid pool size");
+            return false;
+        }
+        if(sdkbar::admob::configureBundlePool(slots, slotBytes)) {
+            rec.rval().set(JSVAL_TRUE);
+        } else {
+            rec.rval().set(JSVAL_FALSE);
+        }
+        return true;
+    } else {
+        JS_ReportError(cx, "Invalid number of arguments");
+        return false;
+    }
+}
+
+static bool jsb_admob_use_bundle_directory(JSContext *cx, uint32_t argc, jsval *vp)
+{
+    printLog("jsb_admob_use_bundle_directory");
     JS::CallArgs args = JS::CallArgsFromVp(argc, vp);
-    JS::RootedObject obj(cx, args.thisv().toObjectOrNull());
     JS::CallReceiver rec = JS::CallReceiverFromVp(vp);
     if(argc == 1) {
-        // key
+        // directory the bundle paths are read from instead of Storage, e.g.
+        // on desktop builds or for bundles shipped in the writable path
         bool ok = true;
-        std::string key;
+        std::string dir;
         JS::RootedValue arg0Val(cx, args.get(0));
-        ok &= jsval_to_std_string(cx, arg0Val, &key);
-        int64_t value = firebase::remote_config::GetLong(key.c_str());
-        rec.rval().set(JS::Int32Value(value));
+        ok &= jsval_to_std_string(cx, arg0Val, &dir);
+        if(!ok) {
+            JS_ReportError(cx, "Invalid directory");
+            return false;
+        }
+        sdkbar::admob::useFileBundleSource(dir);
+        rec.rval().set(JSVAL_TRUE);
         return true;
     } else {
         JS_ReportError(cx, "Invalid number of arguments");
@@ -185,20 +1446,43 @@ static bool jsb_admob_get_integer(JSContext *cx, uint32_t argc, jsval *vp)
     }
 }
 
-static bool jsb_admob_get_double(JSContext *cx, uint32_t argc, jsval *vp)
+static bool jsb_admob_fetch_bundle(JSContext *cx, uint32_t argc, jsval *vp)
 {
-    printLog("jsb_admob_get_double");
+    printLog("jsb_admob_fetch_bundle");
     JS::CallArgs args = JS::CallArgsFromVp(argc, vp);
     JS::RootedObject obj(cx, args.thisv().toObjectOrNull());
     JS::CallReceiver rec = JS::CallReceiverFromVp(vp);
-    if(argc == 1) {
-        // key
+    if(argc == 3) {
+        // bundle name, callback, this. Remote Config key bundle_<name> holds
+        // "<storage path> <sha256 hex>"; false when it is missing or malformed.
         bool ok = true;
-        std::string key;
+        std::string name;
         JS::RootedValue arg0Val(cx, args.get(0));
-        ok &= jsval_to_std_string(cx, arg0Val, &key);
-        double value = firebase::remote_config::GetDouble(key.c_str());
-        rec.rval().set(JS::DoubleValue(value));
+        ok &= jsval_to_std_string(cx, arg0Val, &name);
+        if(!ok) {
+            JS_ReportError(cx, "Invalid bundle name");
+            return false;
+        }
+        std::string key = "bundle_" + name;
+        std::string value;
+        if(remoteConfigReady) {
+            ADMOB_SDK_CALL(kSlotConfig, "remote_config::GetString", key.c_str(), value = firebase::remote_config::GetString(key.c_str()));
+        }
+        size_t separator = value.find(' ');
+        uint8_t digest[32];
+        if(separator == std::string::npos || separator == 0 ||
+           !sdkbar::admob::parseSha256(value.substr(separator + 1), digest)) {
+            rec.rval().set(JSVAL_FALSE);
+            return true;
+        }
+        std::string path = value.substr(0, separator);
+        CallbackFrame *cb = new CallbackFrame(cx, obj, args.get(2), args.get(1));
+        int callbackId = cb->callbackId;
+        uint32_t epoch = callbackEpoch;
+        sdkbar::admob::fetchBundle(path.c_str(), digest, [callbackId, epoch](sdkbar::admob::BundleError error, void *data, size_t size) {
+                callBundleCallback(callbackId, epoch, error, data, size);
+            });
+        rec.rval().set(JSVAL_TRUE);
         return true;
     } else {
         JS_ReportError(cx, "Invalid number of arguments");
@@ -206,20 +1490,31 @@ static bool jsb_admob_get_double(JSContext *cx, uint32_t argc, jsval *vp)
     }
 }
 
-static bool jsb_admob_get_string(JSContext *cx, uint32_t argc, jsval *vp)
+static bool jsb_admob_release_bundle(JSContext *cx, uint32_t argc, jsval *vp)
 {
-    printLog("jsb_admob_get_string");
+    printLog("jsb_admob_release_bundle");
     JS::CallArgs args = JS::CallArgsFromVp(argc, vp);
-    JS::RootedObject obj(cx, args.thisv().toObjectOrNull());
     JS::CallReceiver rec = JS::CallReceiverFromVp(vp);
     if(argc == 1) {
-        // key
-        bool ok = true;
-        std::string key;
-        JS::RootedValue arg0Val(cx, args.get(0));
-        ok &= jsval_to_std_string(cx, arg0Val, &key);
-        std::string value = firebase::remote_config::GetString(key.c_str());
-        rec.rval().set(std_string_to_jsval(cx, value));
+        // ArrayBuffer from fetch_bundle; it is detached (zero length) afterwards
+        JSObject *object = args.get(0).isObject() ? &args.get(0).toObject() : NULL;
+        int index = object != NULL ? findLiveBundle(object) : -1;
+        if(index < 0) {
+            JS_ReportError(cx, "Invalid bundle");
+            return false;
+        }
+        JS::RootedObject buffer(cx, object);
+        void *contents = JS_StealArrayBufferContents(cx, buffer);
+        if(contents == NULL) {
+            JS_ReportError(cx, "Could not release bundle");
+            return false;
+        }
+        // a GC during the steal may have swept other entries
+        index = findLiveBundle(buffer);
+        (*liveBundles)[index] = liveBundles->back();
+        liveBundles->pop_back();
+        sdkbar::admob::releaseBundleBuffer(contents);
+        rec.rval().set(JSVAL_TRUE);
         return true;
     } else {
         JS_ReportError(cx, "Invalid number of arguments");
@@ -229,145 +1524,69 @@ static bool jsb_admob_get_string(JSContext *cx, uint32_t argc, jsval *vp)
 
 ///////////////////////////////////////
 //
-//  Banner
+//  Ads
 //
 ///////////////////////////////////////
 
-typedef struct BannerSettings {
-    firebase::admob::BannerView *bannerView;
-    int callbackId;
-    BannerSettings(firebase::admob::BannerView *ad, int cbId) {
-        bannerView = ad;
-        callbackId = cbId;
-    };
-} BannerSettings;
-
-/*
-static void BannerShowCallback(const firebase::Future<void>& future, void* user_data) {
-    BannerSettings *settings = static_cast<BannerSettings*>(user_data);
-    CallbackFrame *cb = CallbackFrame::getById(settings->callbackId);
-    JS::AutoValueVector valArr(cb->cx);
-    if (future.error() == firebase::admob::kAdMobErrorNone) {
-        printLog("Banner show complete");
-        valArr.append(JSVAL_TRUE);
-    } else {
-        printLog("Banner show error");
-        valArr.append(JSVAL_FALSE);
+// Calls the load_* callback once with the result and frees it, unless it was
+// invalidated since the load started.
+static void callLoadCallback(int callbackId, uint32_t epoch, bool loaded)
+{
+    CallbackFrame *cb = CallbackFrame::getById(callbackId);
+    if(epoch != callbackEpoch) {
+        if(epoch >= contextEpoch) {
+            delete cb;
+        }
+        return;
     }
+    JSAutoRequest rq(cb->cx);
+    JSAutoCompartment ac(cb->cx, cb->_ctxObject.ref());
+    JS::AutoValueVector valArr(cb->cx);
+    valArr.append(loaded ? JSVAL_TRUE : JSVAL_FALSE);
     JS::HandleValueArray funcArgs = JS::HandleValueArray::fromMarkedLocation(1, valArr.begin());
     cb->call(funcArgs);
-    delete settings;
     delete cb;
 }
-*/
-
-static void BannerLoadCallback(const firebase::Future<void>& future, void* user_data) {
-    cocos2d::Director::getInstance()->getScheduler()->performFunctionInCocosThread([future, user_data] {
-            BannerSettings *settings = static_cast<BannerSettings*>(user_data);
-            CallbackFrame *cb = CallbackFrame::getById(settings->callbackId);
-            JSAutoRequest rq(cb->cx);
-            JSAutoCompartment ac(cb->cx, cb->_ctxObject.ref());
-            JS::AutoValueVector valArr(cb->cx);
-            if (future.error() == firebase::admob::kAdMobErrorNone) {
-                printLog("Banner load complete");
-                valArr.append(JSVAL_TRUE);
-            } else {
-                printLog("Banner load error");
-                valArr.append(JSVAL_FALSE);
-            }
-            JS::HandleValueArray funcArgs = JS::HandleValueArray::fromMarkedLocation(1, valArr.begin());
-            cb->call(funcArgs);
-            delete settings;
-            delete cb;
-        });
-}
-
-static void BannerInitCallback(const firebase::Future<void>& future, void* user_data) {
-    BannerSettings *settings = static_cast<BannerSettings*>(user_data);
-    if (future.error() == firebase::admob::kAdMobErrorNone) {
-        printLog("Banner init complete");
-        settings->bannerView->LoadAd(my_ad_request);
-        settings->bannerView->LoadAdLastResult().OnCompletion(BannerLoadCallback, settings);
-    } else {
-        printLog("Banner init error");
-        cocos2d::Director::getInstance()->getScheduler()->performFunctionInCocosThread([settings] {
-                CallbackFrame *cb = CallbackFrame::getById(settings->callbackId);
-                JSAutoRequest rq(cb->cx);
-                JSAutoCompartment ac(cb->cx, cb->_ctxObject.ref());
-                JS::AutoValueVector valArr(cb->cx);
-                valArr.append(JSVAL_FALSE);
-                JS::HandleValueArray funcArgs = JS::HandleValueArray::fromMarkedLocation(1, valArr.begin());
-                cb->call(funcArgs);
-                delete settings;
-                delete cb;
-            });
-    }
-}
 
-static void BannerHideCallback(const firebase::Future<void>& future, void* user_data) {
-    firebase::admob::BannerView *bannerView = static_cast<firebase::admob::BannerView*>(user_data);
-    if (future.error() == firebase::admob::kAdMobErrorNone) {
-        printLog("Banner hide complete");
-        bannerView->Destroy();
-    } else {
-        printLog("Banner hide error");
-    }
-}
-
-class MyBannerViewListener : public firebase::admob::BannerView::Listener {
-    CallbackFrame *cb;
-public:
-    MyBannerViewListener(int callbackId) {
-        cb = CallbackFrame::getById(callbackId);
-    }
-
-    void OnPresentationStateChanged(firebase::admob::BannerView* banner_view, firebase::admob::BannerView::PresentationState state) override {
-        // This method gets called when the banner view's presentation
-        // state changes.
-        cocos2d::Director::getInstance()->getScheduler()->performFunctionInCocosThread([this, state] {
-                printLog("[AdMob] Banner state changed");
-                JSAutoRequest rq(cb->cx);
-                JSAutoCompartment ac(cb->cx, cb->_ctxObject.ref());
-                JS::AutoValueVector valArr(cb->cx);
-                valArr.append(int32_to_jsval(cb->cx, state));
-                JS::HandleValueArray funcArgs = JS::HandleValueArray::fromMarkedLocation(1, valArr.begin());
-                cb->call(funcArgs);
-            });
-    }
-
-    void OnBoundingBoxChanged(firebase::admob::BannerView* banner_view, firebase::admob::BoundingBox box) override {
-        // This method gets called when the banner view's bounding box
-        // changes.
-        printLog("[AdMob] Banner size changed");
-    }
-
-    ~MyBannerViewListener() {
-        delete cb;
-    }
-};
-
-static bool jsb_admob_load_banner(JSContext *cx, uint32_t argc, jsval *vp)
+// load_banner, load_interstitial, load_rewarded: (ad unit id or atom, callback,
+// this) or (ad unit id or atom, handler handle)
+static bool loadAd(JSContext *cx, uint32_t argc, jsval *vp, sdkbar::admob::AdFormat format)
 {
-    printLog("jsb_admob_load_banner");
     JS::CallArgs args = JS::CallArgsFromVp(argc, vp);
     JS::RootedObject obj(cx, args.thisv().toObjectOrNull());
     JS::CallReceiver rec = JS::CallReceiverFromVp(vp);
-    if(argc == 3) {
-        // banner id, callback, this
+    if(argc == 2 || argc == 3) {
         bool ok = true;
-        std::string bannerId;
+        const char *adUnit = NULL;
         JS::RootedValue arg0Val(cx, args.get(0));
-        ok &= jsval_to_std_string(cx, arg0Val, &bannerId);
+        ok &= jsval_to_admob_ad_unit(cx, arg0Val, &adUnit);
+        if(!ok) {
+            JS_ReportError(cx, "Invalid ad unit id");
+            return false;
+        }
+        if(argc == 2) {
+            if(!args.get(1).isInt32() || lookupHandler(args.get(1).toInt32()) == NULL) {
+                JS_ReportError(cx, "Invalid handler");
+                return false;
+            }
+            int handler = args.get(1).toInt32();
+            uint32_t epoch = callbackEpoch;
+            sdkbar::admob::Ads::load(format, adUnit, [handler, epoch](sdkbar::admob::AdHandle ad, bool loaded) {
+                    if(epoch == callbackEpoch) {
+                        callJsHandler(handler, [loaded](JSContext *cx, JS::AutoValueVector &valArr) {
+                                valArr.append(loaded ? JSVAL_TRUE : JSVAL_FALSE);
+                            });
+                    }
+                });
+            rec.rval().set(JSVAL_TRUE);
+            return true;
+        }
         CallbackFrame *cb = new CallbackFrame(cx, obj, args.get(2), args.get(1));
-
-        firebase::admob::AdSize ad_size;
-        ad_size.ad_size_type = firebase::admob::kAdSizeStandard;
-        ad_size.width = 320;
-        ad_size.height = 50;
-        sharedBannerView = new firebase::admob::BannerView();
-        BannerSettings *settings = new BannerSettings(sharedBannerView, cb->callbackId);
-        sharedBannerView->Initialize(getAdParent(), bannerId.c_str(), ad_size);
-        sharedBannerView->InitializeLastResult().OnCompletion(BannerInitCallback, settings);
+        int callbackId = cb->callbackId;
+        uint32_t epoch = callbackEpoch;
+        sdkbar::admob::Ads::load(format, adUnit, [callbackId, epoch](sdkbar::admob::AdHandle ad, bool loaded) {
+                callLoadCallback(callbackId, epoch, loaded);
+            });
         rec.rval().set(JSVAL_TRUE);
         return true;
     } else {
@@ -376,16 +1595,12 @@ static bool jsb_admob_load_banner(JSContext *cx, uint32_t argc, jsval *vp)
     }
 }
 
-static bool jsb_admob_is_banner_loaded(JSContext *cx, uint32_t argc, jsval *vp)
+static bool isAdLoaded(JSContext *cx, uint32_t argc, jsval *vp, sdkbar::admob::AdFormat format)
 {
-    printLog("jsb_admob_is_banner_loaded");
     JS::CallArgs args = JS::CallArgsFromVp(argc, vp);
-    JS::RootedObject obj(cx, args.thisv().toObjectOrNull());
     JS::CallReceiver rec = JS::CallReceiverFromVp(vp);
     if(argc == 0) {
-        if (sharedBannerView != NULL &&
-            sharedBannerView->LoadAdLastResult().status() == firebase::kFutureStatusComplete &&
-            sharedBannerView->LoadAdLastResult().error() == firebase::admob::kAdMobErrorNone) {
+        if(sdkbar::admob::Ads::isLoaded(sdkbar::admob::Ads::current(format))) {
             rec.rval().set(JSVAL_TRUE);
             return true;
         } else {
@@ -398,21 +1613,31 @@ static bool jsb_admob_is_banner_loaded(JSContext *cx, uint32_t argc, jsval *vp)
     }
 }
 
-static bool jsb_admob_show_banner(JSContext *cx, uint32_t argc, jsval *vp)
+// show_banner, show_interstitial, show_rewarded: (callback, this, optional
+// placement id) or (handler handle, optional placement id). The callback
+// receives the ad's events until the next show.
+static bool showAd(JSContext *cx, uint32_t argc, jsval *vp, sdkbar::admob::AdFormat format)
 {
-    printLog("jsb_admob_show_banner");
     JS::CallArgs args = JS::CallArgsFromVp(argc, vp);
     JS::RootedObject obj(cx, args.thisv().toObjectOrNull());
     JS::CallReceiver rec = JS::CallReceiverFromVp(vp);
-    if(argc == 2) {
-        if(sharedBannerView != NULL &&
-           sharedBannerView->LoadAdLastResult().status() == firebase::kFutureStatusComplete &&
-           sharedBannerView->LoadAdLastResult().error() == firebase::admob::kAdMobErrorNone) {
-            CallbackFrame *cb = new CallbackFrame(cx, obj, args.get(1), args.get(0));
-            //BannerSettings *settings = new BannerSettings(sharedBannerView, cb->callbackId);
-            sharedBannerView->SetListener(new MyBannerViewListener(cb->callbackId));
-            sharedBannerView->Show();
-            //sharedBannerView->ShowLastResult().OnCompletion(BannerShowCallback, settings);
+    bool byHandler = argc >= 1 && args.get(0).isInt32();
+    if(byHandler ? (argc == 1 || argc == 2) : (argc == 2 || argc == 3)) {
+        sdkbar::admob::AdHandle ad = sdkbar::admob::Ads::current(format);
+        uint32_t placementArg = byHandler ? 1 : 2;
+        int placement = argc > placementArg && args.get(placementArg).isInt32() ? args.get(placementArg).toInt32() : -1;
+        if(byHandler && lookupHandler(args.get(0).toInt32()) == NULL) {
+            JS_ReportError(cx, "Invalid handler");
+            return false;
+        }
+        if(sdkbar::admob::Ads::isLoaded(ad)) {
+            if(byHandler) {
+                setAdSubscriber((sdkbar::admob::TraceSlot)format, NULL, args.get(0).toInt32());
+            } else {
+                setAdSubscriber((sdkbar::admob::TraceSlot)format, new CallbackFrame(cx, obj, args.get(1), args.get(0)));
+            }
+        }
+        if(sdkbar::admob::Ads::show(ad, placement)) {
             rec.rval().set(JSVAL_TRUE);
             return true;
         } else {
@@ -425,131 +1650,80 @@ static bool jsb_admob_show_banner(JSContext *cx, uint32_t argc, jsval *vp)
     }
 }
 
-static bool jsb_admob_close_banner(JSContext *cx, uint32_t argc, jsval *vp)
+static bool jsb_admob_register_handler(JSContext *cx, uint32_t argc, jsval *vp)
 {
-    printLog("jsb_admob_close_banner");
+    printLog("jsb_admob_register_handler");
     JS::CallArgs args = JS::CallArgsFromVp(argc, vp);
     JS::RootedObject obj(cx, args.thisv().toObjectOrNull());
     JS::CallReceiver rec = JS::CallReceiverFromVp(vp);
-    if(argc == 0) {
-        if(sharedBannerView != NULL &&
-           sharedBannerView->ShowLastResult().status() == firebase::kFutureStatusComplete &&
-           sharedBannerView->ShowLastResult().error() == firebase::admob::kAdMobErrorNone) {
-            sharedBannerView->Hide();
-            sharedBannerView->HideLastResult().OnCompletion(BannerHideCallback, sharedBannerView);
-            sharedBannerView = NULL;
-            rec.rval().set(JSVAL_TRUE);
-            return true;
-        } else {
-            rec.rval().set(JSVAL_FALSE);
+    if(argc == 1 || argc == 2) {
+        // callback, optional this; returns a handle for load_* / show_*
+        JS::RootedValue arg0Val(cx, args.get(0));
+        JS::RootedValue arg1Val(cx, args.get(1));
+        if(!arg0Val.isObject() || !JS_ObjectIsFunction(cx, &arg0Val.toObject())) {
+            JS_ReportError(cx, "Invalid callback");
+            return false;
+        }
+        int handle = registerHandler(cx, arg0Val, arg1Val);
+        if(handle < 0) {
+            JS_ReportError(cx, "Too many handlers");
             return false;
         }
+        rec.rval().set(JS::Int32Value(handle));
+        return true;
     } else {
         JS_ReportError(cx, "Invalid number of arguments");
         return false;
     }
 }
 
-///////////////////////////////////////
-//
-//  Interstitial Ad
-//
-///////////////////////////////////////
-
-typedef struct InterstitialSettings {
-    firebase::admob::InterstitialAd *interstitial_ad;
-    int callbackId;
-    InterstitialSettings(firebase::admob::InterstitialAd *ad, int cbId) {
-        interstitial_ad = ad;
-        callbackId = cbId;
-    };
-} InterstitialSettings;
-
-static void InterstitialLoadCallback(const firebase::Future<void>& future, void* user_data) {
-    cocos2d::Director::getInstance()->getScheduler()->performFunctionInCocosThread([future, user_data] {
-            InterstitialSettings *settings = static_cast<InterstitialSettings*>(user_data);
-            CallbackFrame *cb = CallbackFrame::getById(settings->callbackId);
-            JSAutoRequest rq(cb->cx);
-            JSAutoCompartment ac(cb->cx, cb->_ctxObject.ref());
-            JS::AutoValueVector valArr(cb->cx);
-            if (future.error() == firebase::admob::kAdMobErrorNone) {
-                printLog("Interstitial load complete");
-                valArr.append(JSVAL_TRUE);
-            } else {
-                printLog("Interstitial load error");
-                valArr.append(JSVAL_FALSE);
-            }
-            JS::HandleValueArray funcArgs = JS::HandleValueArray::fromMarkedLocation(1, valArr.begin());
-            cb->call(funcArgs);
-            delete settings;
-            delete cb;
-        });
-}
-
-static void InterstitialInitCallback(const firebase::Future<void>& future, void* user_data) {
-    InterstitialSettings *settings = static_cast<InterstitialSettings*>(user_data);
-    if (future.error() == firebase::admob::kAdMobErrorNone) {
-        settings->interstitial_ad->LoadAd(my_ad_request);
-        settings->interstitial_ad->LoadAdLastResult().OnCompletion(InterstitialLoadCallback, settings);
-        printLog("Interstitial init complete");
-    } else {
-        cocos2d::Director::getInstance()->getScheduler()->performFunctionInCocosThread([settings] {
-                printLog("Interstitial init error");
-                CallbackFrame *cb = CallbackFrame::getById(settings->callbackId);
-                JSAutoRequest rq(cb->cx);
-                JSAutoCompartment ac(cb->cx, cb->_ctxObject.ref());
-                JS::AutoValueVector valArr(cb->cx);
-                valArr.append(JSVAL_FALSE);
-                JS::HandleValueArray funcArgs = JS::HandleValueArray::fromMarkedLocation(1, valArr.begin());
-                cb->call(funcArgs);
-                delete settings;
-                delete cb;
-            });
+static bool jsb_admob_unregister_handler(JSContext *cx, uint32_t argc, jsval *vp)
+{
+    printLog("jsb_admob_unregister_handler");
+    JS::CallArgs args = JS::CallArgsFromVp(argc, vp);
+    JS::RootedObject obj(cx, args.thisv().toObjectOrNull());
+    JS::CallReceiver rec = JS::CallReceiverFromVp(vp);
+    if(argc == 1) {
+        // handler handle; pending results and events for it are dropped
+        JsHandler *h = args.get(0).isInt32() ? lookupHandler(args.get(0).toInt32()) : NULL;
+        if(h != NULL) {
+            releaseHandler(h, true);
+            rec.rval().set(JSVAL_TRUE);
+        } else {
+            rec.rval().set(JSVAL_FALSE);
+        }
+        return true;
+    } else {
+        JS_ReportError(cx, "Invalid number of arguments");
+        return false;
     }
 }
 
-class MyInterstitialAdListener: public firebase::admob::InterstitialAd::Listener {
-    CallbackFrame *cb;
-public:
-    MyInterstitialAdListener(int callbackId) {
-        cb = CallbackFrame::getById(callbackId);
-    };
-
-    void OnPresentationStateChanged(firebase::admob::InterstitialAd* interstitialAd, firebase::admob::InterstitialAd::PresentationState state) override {
-        cocos2d::Director::getInstance()->getScheduler()->performFunctionInCocosThread([this, state] {
-                printLog("[AdMob] InterstitialAd state changed");
-                JSAutoRequest rq(cb->cx);
-                JSAutoCompartment ac(cb->cx, cb->_ctxObject.ref());
-                JS::AutoValueVector valArr(cb->cx);
-                valArr.append(int32_to_jsval(cb->cx, state));
-                JS::HandleValueArray funcArgs = JS::HandleValueArray::fromMarkedLocation(1, valArr.begin());
-                cb->call(funcArgs);
-            });
-    }
-    
-    ~MyInterstitialAdListener() {
-        delete cb;
-    }
-};
-
-static bool jsb_admob_load_interstitial(JSContext *cx, uint32_t argc, jsval *vp)
+static bool jsb_admob_set_event_buffer(JSContext *cx, uint32_t argc, jsval *vp)
 {
-    printLog("jsb_admob_load_interstitial");
+    printLog("jsb_admob_set_event_buffer");
     JS::CallArgs args = JS::CallArgsFromVp(argc, vp);
     JS::RootedObject obj(cx, args.thisv().toObjectOrNull());
     JS::CallReceiver rec = JS::CallReceiverFromVp(vp);
-    if(argc == 3) {
-        // banner id, callback, this
-        CallbackFrame *cb = new CallbackFrame(cx, obj, args.get(2), args.get(1));
-        bool ok = true;
-        std::string bannerId;
+    if(argc == 1) {
+        // Float64Array of at least 5 elements, or null to pass events as arguments
         JS::RootedValue arg0Val(cx, args.get(0));
-        ok &= jsval_to_std_string(cx, arg0Val, &bannerId);
-
-        sharedInterstitialAd = new firebase::admob::InterstitialAd();
-        InterstitialSettings *settings = new InterstitialSettings(sharedInterstitialAd, cb->callbackId);
-        sharedInterstitialAd->Initialize(getAdParent(), bannerId.c_str());
-        sharedInterstitialAd->InitializeLastResult().OnCompletion(InterstitialInitCallback, settings);
+        if(arg0Val.isNull()) {
+            delete eventBuffer;
+            eventBuffer = NULL;
+            rec.rval().set(JSVAL_TRUE);
+            return true;
+        }
+        if(!arg0Val.isObject() || !JS_IsFloat64Array(&arg0Val.toObject()) ||
+           JS_GetTypedArrayLength(&arg0Val.toObject()) < kEventBufferLength) {
+            JS_ReportError(cx, "Invalid event buffer");
+            return false;
+        }
+        if(eventBuffer == NULL) {
+            eventBuffer = new JS::PersistentRootedObject(cx, &arg0Val.toObject());
+        } else {
+            eventBuffer->set(&arg0Val.toObject());
+        }
         rec.rval().set(JSVAL_TRUE);
         return true;
     } else {
@@ -558,41 +1732,60 @@ static bool jsb_admob_load_interstitial(JSContext *cx, uint32_t argc, jsval *vp)
     }
 }
 
-static bool jsb_admob_is_interstitial_loaded(JSContext *cx, uint32_t argc, jsval *vp)
+static bool jsb_admob_invalidate_callbacks(JSContext *cx, uint32_t argc, jsval *vp)
 {
-    printLog("jsb_admob_is_interstitial_loaded");
+    printLog("jsb_admob_invalidate_callbacks");
     JS::CallArgs args = JS::CallArgsFromVp(argc, vp);
     JS::RootedObject obj(cx, args.thisv().toObjectOrNull());
     JS::CallReceiver rec = JS::CallReceiverFromVp(vp);
     if(argc == 0) {
-        if (sharedInterstitialAd != NULL &&
-            sharedInterstitialAd->LoadAdLastResult().status() == firebase::kFutureStatusComplete &&
-            sharedInterstitialAd->LoadAdLastResult().error() == firebase::admob::kAdMobErrorNone) {
-            rec.rval().set(JSVAL_TRUE);
-            return true;
-        } else {
-            rec.rval().set(JSVAL_FALSE);
-            return false;
-        }
+        // pending load callbacks, show subscribers, registered handlers and the
+        // event buffer are dropped, the ads stay
+        invalidateCallbacks(true);
+        rec.rval().set(JSVAL_TRUE);
+        return true;
     } else {
         JS_ReportError(cx, "Invalid number of arguments");
         return false;
     }
 }
 
-static bool jsb_admob_show_interstitial(JSContext *cx, uint32_t argc, jsval *vp)
+///////////////////////////////////////
+//
+//  Banner
+//
+///////////////////////////////////////
+
+static bool jsb_admob_load_banner(JSContext *cx, uint32_t argc, jsval *vp)
 {
-    printLog("jsb_admob_show_interstitial");
+    printLog("jsb_admob_load_banner");
+    ADMOB_TRACE(kTraceJsEntry, kSlotBanner, "jsb_admob_load_banner");
+    return loadAd(cx, argc, vp, sdkbar::admob::kAdFormatBanner);
+}
+
+static bool jsb_admob_is_banner_loaded(JSContext *cx, uint32_t argc, jsval *vp)
+{
+    printLog("jsb_admob_is_banner_loaded");
+    ADMOB_TRACE(kTraceJsEntry, kSlotBanner, "jsb_admob_is_banner_loaded");
+    return isAdLoaded(cx, argc, vp, sdkbar::admob::kAdFormatBanner);
+}
+
+static bool jsb_admob_show_banner(JSContext *cx, uint32_t argc, jsval *vp)
+{
+    printLog("jsb_admob_show_banner");
+    ADMOB_TRACE(kTraceJsEntry, kSlotBanner, "jsb_admob_show_banner");
+    return showAd(cx, argc, vp, sdkbar::admob::kAdFormatBanner);
+}
+
+static bool jsb_admob_close_banner(JSContext *cx, uint32_t argc, jsval *vp)
+{
+    printLog("jsb_admob_close_banner");
+    ADMOB_TRACE(kTraceJsEntry, kSlotBanner, "jsb_admob_close_banner");
     JS::CallArgs args = JS::CallArgsFromVp(argc, vp);
     JS::RootedObject obj(cx, args.thisv().toObjectOrNull());
     JS::CallReceiver rec = JS::CallReceiverFromVp(vp);
-    if(argc == 2) {
-        if (sharedInterstitialAd != NULL &&
-            sharedInterstitialAd->LoadAdLastResult().status() == firebase::kFutureStatusComplete &&
-            sharedInterstitialAd->LoadAdLastResult().error() == firebase::admob::kAdMobErrorNone) {
-            CallbackFrame *cb = new CallbackFrame(cx, obj, args.get(1), args.get(0));
-            sharedInterstitialAd->SetListener(new MyInterstitialAdListener(cb->callbackId));
-            sharedInterstitialAd->Show();
+    if(argc == 0) {
+        if(sdkbar::admob::Ads::hide(sdkbar::admob::Ads::current(sdkbar::admob::kAdFormatBanner))) {
             rec.rval().set(JSVAL_TRUE);
             return true;
         } else {
@@ -607,174 +1800,84 @@ static bool jsb_admob_show_interstitial(JSContext *cx, uint32_t argc, jsval *vp)
 
 ///////////////////////////////////////
 //
-//  Rewarded Ad
+//  Interstitial Ad
 //
 ///////////////////////////////////////
 
-typedef struct RewardedSettings {
-    std::string adId;
-    int callbackId;
-    RewardedSettings(std::string& _adId, int _cbId) {
-        adId = _adId;
-        callbackId = _cbId;
-    };
-} RewardedSettings;
-
-static void RewardedLoadedCallback(const firebase::Future<void>& future, void* user_data) {
-    cocos2d::Director::getInstance()->getScheduler()->performFunctionInCocosThread([future, user_data] {
-            RewardedSettings *settings = static_cast<RewardedSettings*>(user_data);
-            CallbackFrame *cb = CallbackFrame::getById(settings->callbackId);
-            JSAutoRequest rq(cb->cx);
-            JSAutoCompartment ac(cb->cx, cb->_ctxObject.ref());
-            JS::AutoValueVector valArr(cb->cx);
-            if (future.error() == firebase::admob::kAdMobErrorNone) {
-                //firebase::admob::rewarded_video::Show(getAdParent());
-                printLog("Rewarded load complete");
-                valArr.append(JSVAL_TRUE);
-            } else {
-                printLog("Rewarded load error");
-                valArr.append(JSVAL_FALSE);
-            }
-            JS::HandleValueArray funcArgs = JS::HandleValueArray::fromMarkedLocation(1, valArr.begin());
-            cb->call(funcArgs);
-            delete settings;
-            delete cb;
-        });
-}
-
-static void RewardedInitCallback(const firebase::Future<void>& future, void* user_data) {
-    RewardedSettings *settings = static_cast<RewardedSettings*>(user_data);
-    if (future.error() == firebase::admob::kAdMobErrorNone) {
-        rewarded_inited = true;
-        firebase::admob::rewarded_video::LoadAd(settings->adId.c_str(), my_ad_request);
-        firebase::admob::rewarded_video::LoadAdLastResult().OnCompletion(RewardedLoadedCallback, settings);
-        printLog("Rewarded init complete");
-    } else {
-        cocos2d::Director::getInstance()->getScheduler()->performFunctionInCocosThread([settings] {
-                printLog("Rewarded init error");
-                CallbackFrame *cb = CallbackFrame::getById(settings->callbackId);
-                JSAutoRequest rq(cb->cx);
-                JSAutoCompartment ac(cb->cx, cb->_ctxObject.ref());
-                JS::AutoValueVector valArr(cb->cx);
-                valArr.append(JSVAL_FALSE);
-                JS::HandleValueArray funcArgs = JS::HandleValueArray::fromMarkedLocation(1, valArr.begin());
-                cb->call(funcArgs);
-                delete settings;
-                delete cb;
-            });
-    }
+static bool jsb_admob_load_interstitial(JSContext *cx, uint32_t argc, jsval *vp)
+{
+    printLog("jsb_admob_load_interstitial");
+    ADMOB_TRACE(kTraceJsEntry, kSlotInterstitial, "jsb_admob_load_interstitial");
+    return loadAd(cx, argc, vp, sdkbar::admob::kAdFormatInterstitial);
 }
 
-class MyRewardedVideoListener: public firebase::admob::rewarded_video::Listener {
-    CallbackFrame *cb;
-public:
-    MyRewardedVideoListener(int callbackId) {
-        cb = CallbackFrame::getById(callbackId);
-    };
+static bool jsb_admob_is_interstitial_loaded(JSContext *cx, uint32_t argc, jsval *vp)
+{
+    printLog("jsb_admob_is_interstitial_loaded");
+    ADMOB_TRACE(kTraceJsEntry, kSlotInterstitial, "jsb_admob_is_interstitial_loaded");
+    return isAdLoaded(cx, argc, vp, sdkbar::admob::kAdFormatInterstitial);
+}
 
-    void OnRewarded(firebase::admob::rewarded_video::RewardItem item) override {
-        cocos2d::Director::getInstance()->getScheduler()->performFunctionInCocosThread([this] {
-                printLog("[AdMob] On reward item");
-                JSAutoRequest rq(cb->cx);
-                JSAutoCompartment ac(cb->cx, cb->_ctxObject.ref());
-                JS::AutoValueVector valArr(cb->cx);
-                valArr.append(int32_to_jsval(cb->cx, 3));
-                JS::HandleValueArray funcArgs = JS::HandleValueArray::fromMarkedLocation(1, valArr.begin());
-                cb->call(funcArgs);
-            });
-    }
+static bool jsb_admob_show_interstitial(JSContext *cx, uint32_t argc, jsval *vp)
+{
+    printLog("jsb_admob_show_interstitial");
+    ADMOB_TRACE(kTraceJsEntry, kSlotInterstitial, "jsb_admob_show_interstitial");
+    return showAd(cx, argc, vp, sdkbar::admob::kAdFormatInterstitial);
+}
 
-    void OnPresentationStateChanged(firebase::admob::rewarded_video::PresentationState state) override {
-        cocos2d::Director::getInstance()->getScheduler()->performFunctionInCocosThread([this, state] {
-                printLog("[AdMob] InterstitialAd state changed");
-                JSAutoRequest rq(cb->cx);
-                JSAutoCompartment ac(cb->cx, cb->_ctxObject.ref());
-                JS::AutoValueVector valArr(cb->cx);
-                valArr.append(int32_to_jsval(cb->cx, state));
-                JS::HandleValueArray funcArgs = JS::HandleValueArray::fromMarkedLocation(1, valArr.begin());
-                cb->call(funcArgs);
-            });
-    }
-    
-    ~MyRewardedVideoListener() {
-        delete cb;
-    }
-};
+///////////////////////////////////////
+//
+//  Rewarded Ad
+//
+///////////////////////////////////////
 
 static bool jsb_admob_load_rewarded(JSContext *cx, uint32_t argc, jsval *vp)
 {
     printLog("jsb_admob_load_rewarded");
-    JS::CallArgs args = JS::CallArgsFromVp(argc, vp);
-    JS::RootedObject obj(cx, args.thisv().toObjectOrNull());
-    JS::CallReceiver rec = JS::CallReceiverFromVp(vp);
-    if(argc == 3) {
-        // banner id, callback, this
-        CallbackFrame *cb = new CallbackFrame(cx, obj, args.get(2), args.get(1));
-        bool ok = true;
-        std::string bannerId;
-        JS::RootedValue arg0Val(cx, args.get(0));
-        ok &= jsval_to_std_string(cx, arg0Val, &bannerId);
-        RewardedSettings *settings = new RewardedSettings(bannerId, cb->callbackId);
-        if(!rewarded_inited) {
-            firebase::admob::rewarded_video::Initialize();
-            firebase::admob::rewarded_video::InitializeLastResult().OnCompletion(RewardedInitCallback, settings);
-        } else {
-            firebase::admob::rewarded_video::LoadAd(settings->adId.c_str(), my_ad_request);
-            firebase::admob::rewarded_video::LoadAdLastResult().OnCompletion(RewardedLoadedCallback, settings);
-        }
-        rec.rval().set(JSVAL_TRUE);
-        return true;
-    } else {
-        JS_ReportError(cx, "Invalid number of arguments");
-        return false;
-    }
+    ADMOB_TRACE(kTraceJsEntry, kSlotRewarded, "jsb_admob_load_rewarded");
+    return loadAd(cx, argc, vp, sdkbar::admob::kAdFormatRewarded);
 }
 
 static bool jsb_admob_is_rewarded_loaded(JSContext *cx, uint32_t argc, jsval *vp)
 {
     printLog("jsb_admob_is_rewarded_loaded");
+    ADMOB_TRACE(kTraceJsEntry, kSlotRewarded, "jsb_admob_is_rewarded_loaded");
+    return isAdLoaded(cx, argc, vp, sdkbar::admob::kAdFormatRewarded);
+}
+
+static bool jsb_admob_show_rewarded(JSContext *cx, uint32_t argc, jsval *vp)
+{
+    printLog("jsb_admob_show_rewarded");
+    ADMOB_TRACE(kTraceJsEntry, kSlotRewarded, "jsb_admob_show_rewarded");
+    return showAd(cx, argc, vp, sdkbar::admob::kAdFormatRewarded);
+}
+
+static bool jsb_admob_get_rewarded_state(JSContext *cx, uint32_t argc, jsval *vp)
+{
     JS::CallArgs args = JS::CallArgsFromVp(argc, vp);
     JS::RootedObject obj(cx, args.thisv().toObjectOrNull());
     JS::CallReceiver rec = JS::CallReceiverFromVp(vp);
     if(argc == 0) {
-        if (rewarded_inited &&
-            firebase::admob::rewarded_video::LoadAdLastResult().status() == firebase::kFutureStatusComplete &&
-            firebase::admob::rewarded_video::LoadAdLastResult().error() == firebase::admob::kAdMobErrorNone) {
-            rec.rval().set(JSVAL_TRUE);
-            printLog("Admob: rewarded is loaded!");
-            return true;
-        } else {
-            rec.rval().set(JSVAL_FALSE);
-            printLog("Admob: rewarded not loaded");
-            return false;
-        }
+        // 0 idle, 1 initializing, 2 loading, 3 ready, 4 showing, 5 consumed, 6 failed
+        rec.rval().set(JS::Int32Value(sdkbar::admob::Ads::rewardedState()));
+        return true;
     } else {
         JS_ReportError(cx, "Invalid number of arguments");
         return false;
     }
 }
 
-static bool jsb_admob_show_rewarded(JSContext *cx, uint32_t argc, jsval *vp)
+static bool jsb_admob_set_rewarded_autoload(JSContext *cx, uint32_t argc, jsval *vp)
 {
-    printLog("jsb_admob_show_rewarded");
+    printLog("jsb_admob_set_rewarded_autoload");
     JS::CallArgs args = JS::CallArgsFromVp(argc, vp);
     JS::RootedObject obj(cx, args.thisv().toObjectOrNull());
     JS::CallReceiver rec = JS::CallReceiverFromVp(vp);
-    if(argc == 2) {
-        if (firebase::admob::rewarded_video::LoadAdLastResult().status() == firebase::kFutureStatusComplete &&
-            firebase::admob::rewarded_video::LoadAdLastResult().error() == firebase::admob::kAdMobErrorNone) {
-
-            CallbackFrame *cb = new CallbackFrame(cx, obj, args.get(1), args.get(0));
-            firebase::admob::rewarded_video::SetListener(new MyRewardedVideoListener(cb->callbackId));
-            firebase::admob::rewarded_video::Show(getAdParent());
-            rec.rval().set(JSVAL_TRUE);
-            printLog("Admob: rewarded started");
-            return true;
-        } else {
-            rec.rval().set(JSVAL_FALSE);
-            printLog("Admob: rewarded not started");
-            return false;
-        }
+    if(argc == 1) {
+        JS::RootedValue arg0Val(cx, args.get(0));
+        sdkbar::admob::Ads::setRewardedAutoload(JS::ToBoolean(arg0Val));
+        rec.rval().set(JSVAL_TRUE);
+        return true;
     } else {
         JS_ReportError(cx, "Invalid number of arguments");
         return false;
@@ -789,17 +1892,37 @@ static bool jsb_admob_show_rewarded(JSContext *cx, uint32_t argc, jsval *vp)
 
 void register_all_admob_framework(JSContext* cx, JS::HandleObject obj) {
     printLog("[AdMob] register js interface");
+    static bool registered = false;
+    if(registered) {
+        // JS VM was reloaded, everything captured from the old one is stale
+        invalidateCallbacks(false);
+    }
+    registered = true;
     JS::RootedObject ns(cx);
     get_or_create_js_obj(cx, obj, "admob", &ns);
+    sdkbar::admob::Ads::setEventCallback(sdkbar::admob::kAdFormatBanner, onAdEvent);
+    sdkbar::admob::Ads::setEventCallback(sdkbar::admob::kAdFormatInterstitial, onAdEvent);
+    sdkbar::admob::Ads::setEventCallback(sdkbar::admob::kAdFormatRewarded, onAdEvent);
+    sdkbar::admob::setWorkerThreadInit(sdkbar::admob::attachPlatformThread);
 
     JS_DefineFunction(cx, ns, "init", jsb_admob_init, 1, JSPROP_ENUMERATE | JSPROP_PERMANENT);
     JS_DefineFunction(cx, ns, "launch_test_suite", jsb_admob_launch_test_suite, 0, JSPROP_ENUMERATE | JSPROP_PERMANENT);
     JS_DefineFunction(cx, ns, "add_test_device", jsb_admob_add_test_device, 1, JSPROP_ENUMERATE | JSPROP_PERMANENT);
+    JS_DefineFunction(cx, ns, "set_off_thread_sdk_calls", jsb_admob_set_off_thread_sdk_calls, 1, JSPROP_ENUMERATE | JSPROP_PERMANENT);
+    JS_DefineFunction(cx, ns, "intern", jsb_admob_intern, 1, JSPROP_ENUMERATE | JSPROP_PERMANENT);
+    JS_DefineFunction(cx, ns, "atom_string", jsb_admob_atom_string, 1, JSPROP_ENUMERATE | JSPROP_PERMANENT);
+    JS_DefineFunction(cx, ns, "dump_trace", jsb_admob_dump_trace, 0, JSPROP_ENUMERATE | JSPROP_PERMANENT);
+    JS_DefineFunction(cx, ns, "set_stall_budget", jsb_admob_set_stall_budget, 1, JSPROP_ENUMERATE | JSPROP_PERMANENT);
+    JS_DefineFunction(cx, ns, "get_stall_report", jsb_admob_get_stall_report, 0, JSPROP_ENUMERATE | JSPROP_PERMANENT);
+    JS_DefineFunction(cx, ns, "clear_stall_report", jsb_admob_clear_stall_report, 0, JSPROP_ENUMERATE | JSPROP_PERMANENT);
 
+    JS_DefineFunction(cx, ns, "set_config_defaults", jsb_admob_set_config_defaults, 1, JSPROP_ENUMERATE | JSPROP_PERMANENT);
     JS_DefineFunction(cx, ns, "get_boolean", jsb_admob_get_boolean, 1, JSPROP_ENUMERATE | JSPROP_PERMANENT);
     JS_DefineFunction(cx, ns, "get_integer", jsb_admob_get_integer, 1, JSPROP_ENUMERATE | JSPROP_PERMANENT);
+    JS_DefineFunction(cx, ns, "get_integers", jsb_admob_get_integers, 1, JSPROP_ENUMERATE | JSPROP_PERMANENT);
     JS_DefineFunction(cx, ns, "get_double", jsb_admob_get_double, 1, JSPROP_ENUMERATE | JSPROP_PERMANENT);
     JS_DefineFunction(cx, ns, "get_string", jsb_admob_get_string, 1, JSPROP_ENUMERATE | JSPROP_PERMANENT);
+    JS_DefineFunction(cx, ns, "get_data", jsb_admob_get_data, 1, JSPROP_ENUMERATE | JSPROP_PERMANENT);
 
     JS_DefineFunction(cx, ns, "load_banner", jsb_admob_load_banner, 3, JSPROP_ENUMERATE | JSPROP_PERMANENT);
     JS_DefineFunction(cx, ns, "is_banner_loaded", jsb_admob_is_banner_loaded, 0, JSPROP_ENUMERATE | JSPROP_PERMANENT);
@@ -813,5 +1936,27 @@ void register_all_admob_framework(JSContext* cx, JS::HandleObject obj) {
     JS_DefineFunction(cx, ns, "load_rewarded", jsb_admob_load_rewarded, 3, JSPROP_ENUMERATE | JSPROP_PERMANENT);
     JS_DefineFunction(cx, ns, "is_rewarded_loaded", jsb_admob_is_rewarded_loaded, 0, JSPROP_ENUMERATE | JSPROP_PERMANENT);
     JS_DefineFunction(cx, ns, "show_rewarded", jsb_admob_show_rewarded, 2, JSPROP_ENUMERATE | JSPROP_PERMANENT);
+    JS_DefineFunction(cx, ns, "get_rewarded_state", jsb_admob_get_rewarded_state, 0, JSPROP_ENUMERATE | JSPROP_PERMANENT);
+    JS_DefineFunction(cx, ns, "set_rewarded_autoload", jsb_admob_set_rewarded_autoload, 1, JSPROP_ENUMERATE | JSPROP_PERMANENT);
+    JS_DefineFunction(cx, ns, "register_handler", jsb_admob_register_handler, 2, JSPROP_ENUMERATE | JSPROP_PERMANENT);
+    JS_DefineFunction(cx, ns, "unregister_handler", jsb_admob_unregister_handler, 1, JSPROP_ENUMERATE | JSPROP_PERMANENT);
+    JS_DefineFunction(cx, ns, "set_event_buffer", jsb_admob_set_event_buffer, 1, JSPROP_ENUMERATE | JSPROP_PERMANENT);
+    JS_DefineFunction(cx, ns, "invalidate_callbacks", jsb_admob_invalidate_callbacks, 0, JSPROP_ENUMERATE | JSPROP_PERMANENT);
+
+    JS_DefineFunction(cx, ns, "define_placement", jsb_admob_define_placement, 2, JSPROP_ENUMERATE | JSPROP_PERMANENT);
+    JS_DefineFunction(cx, ns, "set_placement_hints", jsb_admob_set_placement_hints, 5, JSPROP_ENUMERATE | JSPROP_PERMANENT);
+    JS_DefineFunction(cx, ns, "set_pacing_rule", jsb_admob_set_pacing_rule, 6, JSPROP_ENUMERATE | JSPROP_PERMANENT);
+    JS_DefineFunction(cx, ns, "best_ad", jsb_admob_best_ad, 1, JSPROP_ENUMERATE | JSPROP_PERMANENT);
+
+    JS_DefineFunction(cx, ns, "read_telemetry", jsb_admob_read_telemetry, 1, JSPROP_ENUMERATE | JSPROP_PERMANENT);
+    JS_DefineFunction(cx, ns, "ack_telemetry", jsb_admob_ack_telemetry, 1, JSPROP_ENUMERATE | JSPROP_PERMANENT);
+
+    JS_DefineFunction(cx, ns, "live_ops_subscribe", jsb_admob_live_ops_subscribe, 3, JSPROP_ENUMERATE | JSPROP_PERMANENT);
+    JS_DefineFunction(cx, ns, "live_ops_unsubscribe", jsb_admob_live_ops_unsubscribe, 0, JSPROP_ENUMERATE | JSPROP_PERMANENT);
+    JS_DefineFunction(cx, ns, "live_ops_get", jsb_admob_live_ops_get, 1, JSPROP_ENUMERATE | JSPROP_PERMANENT);
+    JS_DefineFunction(cx, ns, "configure_bundles", jsb_admob_configure_bundles, 2, JSPROP_ENUMERATE | JSPROP_PERMANENT);
+    JS_DefineFunction(cx, ns, "use_bundle_directory", jsb_admob_use_bundle_directory, 1, JSPROP_ENUMERATE | JSPROP_PERMANENT);
+    JS_DefineFunction(cx, ns, "fetch_bundle", jsb_admob_fetch_bundle, 3, JSPROP_ENUMERATE | JSPROP_PERMANENT);
+    JS_DefineFunction(cx, ns, "release_bundle", jsb_admob_release_bundle, 1, JSPROP_ENUMERATE | JSPROP_PERMANENT);
 
 }
@@ -1,14 +1,7 @@
-#ifndef AdMob_h
-#define AdMob_h
+#ifndef AdMob_hpp
+#define AdMob_hpp
 
-#include "base/ccConfig.h"
-#include "jsapi.h"
-#include "jsfriendapi.h"
-#include "platform/android/jni/JniHelper.h"
-#include <jni.h>
-#include "firebase/admob/types.h"
+// Kept for the Android app delegate include; the bindings are shared.
+#include "AdMob.h"
 
-void register_all_admob_framework(JSContext* cx, JS::HandleObject obj);
-firebase::admob::AdParent getAdParent();
-
-#endif /* AdMob_h */
+#endif /* AdMob_hpp */
@@ -0,0 +1,760 @@
+#include "AdMobAds.h"
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string.h>
+#include <vector>
+#include "base/CCDirector.h"
+#include "base/CCScheduler.h"
+#include "AdMobAnalytics.h"
+#include "AdMobArbiter.h"
+#include "AdMobAtoms.h"
+#include "AdMobPlatform.h"
+#include "AdMobWatchdog.h"
+#include "AdMobWorker.h"
+#include "firebase/admob.h"
+#include "firebase/admob/banner_view.h"
+#include "firebase/admob/interstitial_ad.h"
+#include "firebase/admob/rewarded_video.h"
+
+namespace sdkbar {
+namespace admob {
+
+// The ad request is read by LoadAd on SDK and worker threads while test
+// devices may be added, so it is published as an immutable snapshot.
+struct AdRequestSnapshot {
+    std::vector<std::string> testDeviceIds;
+    std::vector<const char*> testDevices;
+    firebase::admob::AdRequest request;
+    AdRequestSnapshot() : request() {}
+};
+static std::mutex adRequestMutex;
+static std::shared_ptr<const AdRequestSnapshot> my_ad_request = std::make_shared<AdRequestSnapshot>();
+
+// Confined to the cocos thread. An ad object is published here only once
+// its LoadAd completed, so Show/Hide/status calls never overlap the
+// Initialize/LoadAd still running on the worker.
+static firebase::admob::BannerView *sharedBannerView = NULL;
+static firebase::admob::InterstitialAd *sharedInterstitialAd = NULL;
+// The interstitial on screen; it is retired once hidden.
+static firebase::admob::InterstitialAd *shownInterstitialAd = NULL;
+static const char *bannerAdUnit = NULL;
+static const char *interstitialAdUnit = NULL;
+static EventCallback eventCallbacks[kSlotConfig];
+
+// Shared with SDK completion threads.
+static std::atomic<uint32_t> adSerials[kSlotConfig];
+static std::atomic<bool> rewarded_inited(false);
+// Ad unit of the ad the rewarded stream holds or shows.
+static std::atomic<const char*> rewardedAdUnit(NULL);
+static std::atomic<int> rewardedStreamState(kRewardedIdle);
+static std::atomic<bool> rewardedAutoload(true);
+// Blocking SDK calls (Initialize, LoadAd, Destroy) are dispatched through
+// these: inline, or on the AdMob worker thread when setOffThreadSdkCalls(true)
+// is on. Each ad object has its own queue so calls on it keep their order.
+static SerialQueue bannerQueue;
+static SerialQueue interstitialQueue;
+static SerialQueue rewardedQueue;
+// Lifecycle timing for analytics, in trace microseconds; 0 when not pending.
+static std::atomic<const char*> shownAdUnit[kSlotConfig];
+static std::atomic<uint64_t> showStartUs[kSlotConfig];
+static std::atomic<uint64_t> impressionUs[kSlotConfig];
+
+static void printLog(const char* str) {
+    CCLOG("%s", str);
+}
+
+static std::shared_ptr<const AdRequestSnapshot> currentAdRequest() {
+    std::lock_guard<std::mutex> lock(adRequestMutex);
+    return my_ad_request;
+}
+
+static AdHandle nextHandle(AdFormat format)
+{
+    AdHandle handle = { format, ++adSerials[format] };
+    return handle;
+}
+
+static bool isCurrent(AdHandle ad)
+{
+    return ad.serial != 0 && ad.serial == adSerials[ad.format].load();
+}
+
+static uint32_t msSince(uint64_t startUs, uint64_t nowUs)
+{
+    return nowUs > startUs ? (uint32_t)((nowUs - startUs) / 1000) : 0;
+}
+
+///////////////////////////////////////
+//
+//  Ad Objects
+//
+///////////////////////////////////////
+
+// An ad object that will not be shown again is destroyed on its queue and
+// freed there once Destroy, its last future, has completed. The delete is
+// posted rather than done in the completion callback, which runs inside
+// the object's own future machinery.
+static void BannerDestroyCallback(const firebase::Future<void>& future, void* user_data) {
+    ADMOB_TRACE(kTraceFutureComplete, kSlotBanner, "BannerDestroyCallback");
+    firebase::admob::BannerView *bannerView = static_cast<firebase::admob::BannerView*>(user_data);
+    bannerQueue.post([bannerView] {
+            delete bannerView;
+        });
+}
+
+static void retireBanner(firebase::admob::BannerView *bannerView, const char *caller)
+{
+    bannerQueue.dispatch([bannerView, caller] {
+            ADMOB_SDK_CALL_FROM(caller, kSlotBanner, "BannerView::Destroy", NULL, bannerView->Destroy());
+            bannerView->DestroyLastResult().OnCompletion(BannerDestroyCallback, bannerView);
+        });
+}
+
+// InterstitialAd has no Destroy; its destructor releases the platform ad.
+// Callers retire it only once its last future has completed.
+static void retireInterstitial(firebase::admob::InterstitialAd *interstitialAd)
+{
+    interstitialQueue.dispatch([interstitialAd] {
+            delete interstitialAd;
+        });
+}
+
+///////////////////////////////////////
+//
+//  Events
+//
+///////////////////////////////////////
+
+struct LoadRequest {
+    AdHandle handle;
+    const char *adUnit;
+    LoadCallback done;
+    firebase::admob::BannerView *bannerView;
+    firebase::admob::InterstitialAd *interstitialAd;
+    uint64_t startUs;
+    LoadRequest(AdHandle h, const char *unit, const LoadCallback &cb) : handle(h), adUnit(unit), done(cb), bannerView(NULL), interstitialAd(NULL), startUs(traceNow()) {}
+};
+
+// Reports a finished load on the cocos thread and frees the request. A
+// loaded banner or interstitial that is still current is published, and
+// only then offered to the arbiter; a failed or superseded one is retired.
+static void deliverLoad(LoadRequest *request, bool loaded, const char *name)
+{
+    trace(kTraceSchedulerHop, (TraceSlot)request->handle.format, name);
+    cocos2d::Director::getInstance()->getScheduler()->performFunctionInCocosThread([request, loaded, name] {
+            printLog(loaded ? "[AdMob] load complete" : "[AdMob] load error");
+            if(loaded && isCurrent(request->handle)) {
+                if(request->bannerView != NULL) {
+                    sharedBannerView = request->bannerView;
+                } else if(request->interstitialAd != NULL) {
+                    sharedInterstitialAd = request->interstitialAd;
+                    setInventoryReady(kAdInterstitial, true);
+                }
+            } else if(request->bannerView != NULL) {
+                retireBanner(request->bannerView, name);
+            } else if(request->interstitialAd != NULL) {
+                retireInterstitial(request->interstitialAd);
+            }
+            trace(kTraceJsCallback, (TraceSlot)request->handle.format, name);
+            if(request->done) {
+                request->done(request->handle, loaded);
+            }
+            delete request;
+        });
+}
+
+// Logs the fill or no-fill of the request's own SDK load, then delivers it.
+static void finishLoad(LoadRequest *request, bool loaded, const char *name)
+{
+    logAdLifecycle(loaded ? kLifecycleFill : kLifecycleNoFill, request->handle.format, request->adUnit, msSince(request->startUs, traceNow()));
+    deliverLoad(request, loaded, name);
+}
+
+static void dispatchEvent(const AdEvent &event, const char *name)
+{
+    trace(kTraceSchedulerHop, (TraceSlot)event.format, name);
+    cocos2d::Director::getInstance()->getScheduler()->performFunctionInCocosThread([event, name] {
+            trace(kTraceJsCallback, (TraceSlot)event.format, name);
+            if(eventCallbacks[event.format]) {
+                eventCallbacks[event.format](event);
+            }
+        });
+}
+
+// Set before Show so the presentation listener can time the impression.
+static void markShown(AdFormat format, const char *adUnit)
+{
+    shownAdUnit[format] = adUnit;
+    showStartUs[format] = traceNow();
+}
+
+// Impression once the shown ad becomes visible, close when it is hidden.
+static void trackPresentation(AdFormat format, bool visible, bool hidden)
+{
+    uint64_t now = traceNow();
+    if(visible) {
+        uint64_t shown = showStartUs[format].exchange(0);
+        if(shown != 0) {
+            impressionUs[format] = now;
+            logAdLifecycle(kLifecycleImpression, format, shownAdUnit[format], msSince(shown, now));
+        }
+    } else if(hidden) {
+        uint64_t impression = impressionUs[format].exchange(0);
+        if(impression != 0) {
+            logAdLifecycle(kLifecycleClose, format, shownAdUnit[format], msSince(impression, now));
+        }
+    }
+}
+
+static void dispatchPresentationState(AdFormat format, int32_t state)
+{
+    AdEvent event = { format, kAdEventPresentationState, state, 0, -1 };
+    dispatchEvent(event, "OnPresentationStateChanged");
+}
+
+// The reward type is interned once on the cocos thread.
+static void dispatchReward(float amount, const std::string &rewardType)
+{
+    logAdLifecycle(kLifecycleReward, kAdFormatRewarded, shownAdUnit[kAdFormatRewarded], msSince(impressionUs[kAdFormatRewarded], traceNow()), amount);
+    trace(kTraceSchedulerHop, kSlotRewarded, "OnRewarded");
+    cocos2d::Director::getInstance()->getScheduler()->performFunctionInCocosThread([amount, rewardType] {
+            AdEvent event = { kAdFormatRewarded, kAdEventReward, 0, amount, internString(rewardType) };
+            trace(kTraceJsCallback, kSlotRewarded, "OnRewarded");
+            if(eventCallbacks[kAdFormatRewarded]) {
+                eventCallbacks[kAdFormatRewarded](event);
+            }
+        });
+}
+
+///////////////////////////////////////
+//
+//  Banner
+//
+///////////////////////////////////////
+
+static void BannerLoadCallback(const firebase::Future<void>& future, void* user_data) {
+    ADMOB_TRACE(kTraceFutureComplete, kSlotBanner, "BannerLoadCallback");
+    finishLoad(static_cast<LoadRequest*>(user_data), future.error() == firebase::admob::kAdMobErrorNone, "BannerLoadCallback");
+}
+
+static void BannerInitCallback(const firebase::Future<void>& future, void* user_data) {
+    ADMOB_TRACE(kTraceFutureComplete, kSlotBanner, "BannerInitCallback");
+    LoadRequest *request = static_cast<LoadRequest*>(user_data);
+    if (future.error() == firebase::admob::kAdMobErrorNone) {
+        printLog("Banner init complete");
+        bannerQueue.dispatch([request] {
+                ADMOB_SDK_CALL_FROM("BannerInitCallback", kSlotBanner, "BannerView::LoadAd", request->adUnit, request->bannerView->LoadAd(currentAdRequest()->request));
+                request->bannerView->LoadAdLastResult().OnCompletion(BannerLoadCallback, request);
+            });
+    } else {
+        printLog("Banner init error");
+        finishLoad(request, false, "BannerInitCallback");
+    }
+}
+
+static void BannerHideCallback(const firebase::Future<void>& future, void* user_data) {
+    ADMOB_TRACE(kTraceFutureComplete, kSlotBanner, "BannerHideCallback");
+    if (future.error() == firebase::admob::kAdMobErrorNone) {
+        printLog("Banner hide complete");
+    } else {
+        printLog("Banner hide error");
+    }
+    // unpublished by Ads::hide, destroyed either way
+    retireBanner(static_cast<firebase::admob::BannerView*>(user_data), "BannerHideCallback");
+}
+
+class MyBannerViewListener : public firebase::admob::BannerView::Listener {
+public:
+    void OnPresentationStateChanged(firebase::admob::BannerView* banner_view, firebase::admob::BannerView::PresentationState state) override {
+        printLog("[AdMob] Banner state changed");
+        trackPresentation(kAdFormatBanner, state == firebase::admob::BannerView::kPresentationStateVisibleWithAd,
+                          state == firebase::admob::BannerView::kPresentationStateHidden);
+        dispatchPresentationState(kAdFormatBanner, state);
+    }
+
+    void OnBoundingBoxChanged(firebase::admob::BannerView* banner_view, firebase::admob::BoundingBox box) override {
+        printLog("[AdMob] Banner size changed");
+    }
+};
+
+static MyBannerViewListener bannerListener;
+
+static AdHandle loadBanner(const char *adUnit, const LoadCallback &done)
+{
+    firebase::admob::AdSize ad_size;
+    ad_size.ad_size_type = firebase::admob::kAdSizeStandard;
+    ad_size.width = 320;
+    ad_size.height = 50;
+    if(sharedBannerView != NULL) {
+        retireBanner(sharedBannerView, "Ads::load");
+        sharedBannerView = NULL;
+    }
+    bannerAdUnit = adUnit;
+    LoadRequest *request = new LoadRequest(nextHandle(kAdFormatBanner), adUnit, done);
+    request->bannerView = new firebase::admob::BannerView();
+    firebase::admob::AdParent parent = platformAdParent();
+    bannerQueue.dispatch([request, parent, ad_size] {
+            ADMOB_SDK_CALL_FROM("Ads::load", kSlotBanner, "BannerView::Initialize", request->adUnit, request->bannerView->Initialize(parent, request->adUnit, ad_size));
+            request->bannerView->InitializeLastResult().OnCompletion(BannerInitCallback, request);
+        });
+    return request->handle;
+}
+
+///////////////////////////////////////
+//
+//  Interstitial Ad
+//
+///////////////////////////////////////
+
+static void InterstitialLoadCallback(const firebase::Future<void>& future, void* user_data) {
+    ADMOB_TRACE(kTraceFutureComplete, kSlotInterstitial, "InterstitialLoadCallback");
+    LoadRequest *request = static_cast<LoadRequest*>(user_data);
+    finishLoad(request, future.error() == firebase::admob::kAdMobErrorNone, "InterstitialLoadCallback");
+}
+
+static void InterstitialInitCallback(const firebase::Future<void>& future, void* user_data) {
+    ADMOB_TRACE(kTraceFutureComplete, kSlotInterstitial, "InterstitialInitCallback");
+    LoadRequest *request = static_cast<LoadRequest*>(user_data);
+    if (future.error() == firebase::admob::kAdMobErrorNone) {
+        interstitialQueue.dispatch([request] {
+                ADMOB_SDK_CALL_FROM("InterstitialInitCallback", kSlotInterstitial, "InterstitialAd::LoadAd", request->adUnit, request->interstitialAd->LoadAd(currentAdRequest()->request));
+                request->interstitialAd->LoadAdLastResult().OnCompletion(InterstitialLoadCallback, request);
+            });
+        printLog("Interstitial init complete");
+    } else {
+        printLog("Interstitial init error");
+        finishLoad(request, false, "InterstitialInitCallback");
+    }
+}
+
+class MyInterstitialAdListener: public firebase::admob::InterstitialAd::Listener {
+public:
+    void OnPresentationStateChanged(firebase::admob::InterstitialAd* interstitialAd, firebase::admob::InterstitialAd::PresentationState state) override {
+        printLog("[AdMob] InterstitialAd state changed");
+        trackPresentation(kAdFormatInterstitial, state == firebase::admob::InterstitialAd::kPresentationStateCoveringUI,
+                          state == firebase::admob::InterstitialAd::kPresentationStateHidden);
+        if(state == firebase::admob::InterstitialAd::kPresentationStateHidden) {
+            cocos2d::Director::getInstance()->getScheduler()->performFunctionInCocosThread([interstitialAd] {
+                    if(interstitialAd == shownInterstitialAd) {
+                        shownInterstitialAd = NULL;
+                        retireInterstitial(interstitialAd);
+                    }
+                });
+        }
+        dispatchPresentationState(kAdFormatInterstitial, state);
+    }
+};
+
+static MyInterstitialAdListener interstitialListener;
+
+static AdHandle loadInterstitial(const char *adUnit, const LoadCallback &done)
+{
+    setInventoryReady(kAdInterstitial, false);
+    if(sharedInterstitialAd != NULL) {
+        retireInterstitial(sharedInterstitialAd);
+        sharedInterstitialAd = NULL;
+    }
+    interstitialAdUnit = adUnit;
+    LoadRequest *request = new LoadRequest(nextHandle(kAdFormatInterstitial), adUnit, done);
+    request->interstitialAd = new firebase::admob::InterstitialAd();
+    firebase::admob::AdParent parent = platformAdParent();
+    interstitialQueue.dispatch([request, parent] {
+            ADMOB_SDK_CALL_FROM("Ads::load", kSlotInterstitial, "InterstitialAd::Initialize", request->adUnit, request->interstitialAd->Initialize(parent, request->adUnit));
+            request->interstitialAd->InitializeLastResult().OnCompletion(InterstitialInitCallback, request);
+        });
+    return request->handle;
+}
+
+///////////////////////////////////////
+//
+//  Rewarded Ad
+//
+///////////////////////////////////////
+
+// rewarded_video holds one ad and runs one Initialize/LoadAd at a time. The
+// wanted load and every request waiting on it are kept here, and the SDK
+// completion delivers to all of them at once. A request for another ad unit
+// replaces the wanted load; it starts once the running SDK call is done.
+struct RewardedLoad {
+    uint32_t serial;        // handle of the wanted ad, 0 when none
+    const char *adUnit;
+    uint32_t issuedSerial;  // handle the running SDK call loads, 0 when idle
+    uint64_t startUs;
+    std::vector<LoadRequest*> waiters;
+};
+static std::mutex rewardedMutex;
+static RewardedLoad rewardedLoad;
+
+static void RewardedInitCallback(const firebase::Future<void>& future, void* user_data);
+static void RewardedLoadedCallback(const firebase::Future<void>& future, void* user_data);
+
+// rewardedMutex held. Marks the wanted load as running unless an SDK call is
+// already running or an ad is on screen; the caller then starts it with
+// startRewardedLoad() once the mutex is released, as inline SDK calls may
+// complete synchronously.
+static bool issueRewardedLoad()
+{
+    if(rewardedLoad.serial == 0 || rewardedLoad.issuedSerial != 0) {
+        return false;
+    }
+    int state = rewardedStreamState;
+    int next = rewarded_inited ? kRewardedLoading : kRewardedInitializing;
+    do {
+        if(state == kRewardedShowing) {
+            // picked up by RewardedPreloadNext once the ad closes
+            return false;
+        }
+    } while(!rewardedStreamState.compare_exchange_weak(state, next));
+    setInventoryReady(kAdRewarded, false);
+    rewardedLoad.issuedSerial = rewardedLoad.serial;
+    rewardedLoad.startUs = traceNow();
+    return true;
+}
+
+// The serial travels as the completion's user data, see completeRewardedLoad.
+static void startRewardedLoad(uint32_t serial, const char *adUnit, const char *caller)
+{
+    void *token = (void*)(uintptr_t)serial;
+    if(!rewarded_inited) {
+        rewardedQueue.dispatch([adUnit, caller, token] {
+                ADMOB_SDK_CALL_FROM(caller, kSlotRewarded, "rewarded_video::Initialize", adUnit, firebase::admob::rewarded_video::Initialize());
+                firebase::admob::rewarded_video::InitializeLastResult().OnCompletion(RewardedInitCallback, token);
+            });
+    } else {
+        rewardedQueue.dispatch([adUnit, caller, token] {
+                ADMOB_SDK_CALL_FROM(caller, kSlotRewarded, "rewarded_video::LoadAd", adUnit, firebase::admob::rewarded_video::LoadAd(adUnit, currentAdRequest()->request));
+                firebase::admob::rewarded_video::LoadAdLastResult().OnCompletion(RewardedLoadedCallback, token);
+            });
+    }
+}
+
+// Finishes the SDK call issued for serial. A completion for a load that was
+// replaced meanwhile only starts the wanted one; otherwise the stream moves
+// to Ready or Failed and every waiter is notified.
+static void completeRewardedLoad(uint32_t serial, bool loaded, const char *name)
+{
+    std::vector<LoadRequest*> waiters;
+    const char *adUnit = NULL;
+    uint64_t startUs = 0;
+    bool restart = false;
+    {
+        std::lock_guard<std::mutex> lock(rewardedMutex);
+        if(serial != rewardedLoad.issuedSerial) {
+            return;
+        }
+        rewardedLoad.issuedSerial = 0;
+        if(serial != rewardedLoad.serial) {
+            restart = issueRewardedLoad();
+            serial = rewardedLoad.serial;
+            adUnit = rewardedLoad.adUnit;
+        } else {
+            waiters.swap(rewardedLoad.waiters);
+            adUnit = rewardedLoad.adUnit;
+            startUs = rewardedLoad.startUs;
+            rewardedLoad.serial = 0;
+            int state = rewardedStreamState;
+            if((state == kRewardedLoading || state == kRewardedInitializing) &&
+               rewardedStreamState.compare_exchange_strong(state, loaded ? kRewardedReady : kRewardedFailed)) {
+                rewardedAdUnit = adUnit;
+                setInventoryReady(kAdRewarded, loaded);
+            }
+        }
+    }
+    if(restart) {
+        startRewardedLoad(serial, adUnit, name);
+        return;
+    }
+    // one fill per SDK load, however many requests waited on it
+    logAdLifecycle(loaded ? kLifecycleFill : kLifecycleNoFill, kAdFormatRewarded, adUnit, msSince(startUs, traceNow()));
+    for(size_t i = 0; i < waiters.size(); i++) {
+        deliverLoad(waiters[i], loaded, name);
+    }
+}
+
+static void RewardedLoadedCallback(const firebase::Future<void>& future, void* user_data) {
+    ADMOB_TRACE(kTraceFutureComplete, kSlotRewarded, "RewardedLoadedCallback");
+    completeRewardedLoad((uint32_t)(uintptr_t)user_data, future.error() == firebase::admob::kAdMobErrorNone, "RewardedLoadedCallback");
+}
+
+// Starts the next ad after the current one closed or failed to show: the
+// load requested meanwhile if any, else with autoload a new one for the same
+// ad unit, so back-to-back rewarded placements do not wait on a fresh load.
+static void RewardedPreloadNext() {
+    bool preload = false;
+    bool start = false;
+    uint32_t serial = 0;
+    const char *adUnit = NULL;
+    {
+        std::lock_guard<std::mutex> lock(rewardedMutex);
+        if(rewardedLoad.serial == 0) {
+            if(!rewardedAutoload || rewardedAdUnit.load() == NULL) {
+                return;
+            }
+            rewardedLoad.serial = nextHandle(kAdFormatRewarded).serial;
+            rewardedLoad.adUnit = rewardedAdUnit;
+            preload = true;
+        }
+        start = issueRewardedLoad();
+        serial = rewardedLoad.serial;
+        adUnit = rewardedLoad.adUnit;
+    }
+    if(preload) {
+        logAdLifecycle(kLifecycleRequest, kAdFormatRewarded, adUnit, 0);
+    }
+    if(start) {
+        startRewardedLoad(serial, adUnit, "RewardedPreloadNext");
+    }
+}
+
+static void RewardedShowCallback(const firebase::Future<void>& future, void* user_data) {
+    ADMOB_TRACE(kTraceFutureComplete, kSlotRewarded, "RewardedShowCallback");
+    if (future.error() != firebase::admob::kAdMobErrorNone) {
+        printLog("Rewarded show error");
+        int showing = kRewardedShowing;
+        if(rewardedStreamState.compare_exchange_strong(showing, kRewardedFailed)) {
+            RewardedPreloadNext();
+        }
+    }
+}
+
+// After a successful Initialize the wanted load, which may have been
+// replaced meanwhile, goes straight to LoadAd.
+static void RewardedInitCallback(const firebase::Future<void>& future, void* user_data) {
+    ADMOB_TRACE(kTraceFutureComplete, kSlotRewarded, "RewardedInitCallback");
+    uint32_t serial = (uint32_t)(uintptr_t)user_data;
+    if (future.error() != firebase::admob::kAdMobErrorNone) {
+        printLog("Rewarded init error");
+        completeRewardedLoad(serial, false, "RewardedInitCallback");
+        return;
+    }
+    printLog("Rewarded init complete");
+    rewarded_inited = true;
+    const char *adUnit = NULL;
+    {
+        std::lock_guard<std::mutex> lock(rewardedMutex);
+        if(serial != rewardedLoad.issuedSerial) {
+            return;
+        }
+        int initializing = kRewardedInitializing;
+        rewardedStreamState.compare_exchange_strong(initializing, kRewardedLoading);
+        serial = rewardedLoad.serial;
+        adUnit = rewardedLoad.adUnit;
+        rewardedLoad.issuedSerial = serial;
+    }
+    startRewardedLoad(serial, adUnit, "RewardedInitCallback");
+}
+
+class MyRewardedVideoListener: public firebase::admob::rewarded_video::Listener {
+public:
+    void OnRewarded(firebase::admob::rewarded_video::RewardItem item) override {
+        printLog("[AdMob] On reward item");
+        dispatchReward(item.amount, item.reward_type);
+    }
+
+    void OnPresentationStateChanged(firebase::admob::rewarded_video::PresentationState state) override {
+        int showing = kRewardedShowing;
+        if(state == firebase::admob::rewarded_video::kPresentationStateHidden &&
+           rewardedStreamState.compare_exchange_strong(showing, kRewardedConsumed)) {
+            RewardedPreloadNext();
+        }
+        printLog("[AdMob] RewardedVideo state changed");
+        trackPresentation(kAdFormatRewarded, state == firebase::admob::rewarded_video::kPresentationStateCoveringUI,
+                          state == firebase::admob::rewarded_video::kPresentationStateHidden);
+        dispatchPresentationState(kAdFormatRewarded, state);
+    }
+};
+
+static MyRewardedVideoListener rewardedListener;
+
+static AdHandle loadRewarded(const char *adUnit, const LoadCallback &done)
+{
+    LoadRequest *request = NULL;
+    std::vector<LoadRequest*> replaced;
+    bool ready = false;
+    bool start = false;
+    {
+        std::lock_guard<std::mutex> lock(rewardedMutex);
+        const char *readyUnit = rewardedAdUnit;
+        if(rewardedLoad.serial != 0 && strcmp(rewardedLoad.adUnit, adUnit) == 0) {
+            // this ad unit is already loading (or waiting for the shown ad to
+            // close), report that load
+            AdHandle handle = { kAdFormatRewarded, rewardedLoad.serial };
+            request = new LoadRequest(handle, adUnit, done);
+            rewardedLoad.waiters.push_back(request);
+            return handle;
+        }
+        if(rewardedLoad.serial == 0 && rewardedStreamState == kRewardedReady &&
+           readyUnit != NULL && strcmp(readyUnit, adUnit) == 0) {
+            // the stream already holds an ad for this unit
+            request = new LoadRequest(Ads::current(kAdFormatRewarded), adUnit, done);
+            ready = true;
+        } else {
+            replaced.swap(rewardedLoad.waiters);
+            request = new LoadRequest(nextHandle(kAdFormatRewarded), adUnit, done);
+            rewardedLoad.serial = request->handle.serial;
+            rewardedLoad.adUnit = adUnit;
+            rewardedLoad.waiters.push_back(request);
+            start = issueRewardedLoad();
+        }
+    }
+    // waiters of a load for another ad unit will not get their ad
+    for(size_t i = 0; i < replaced.size(); i++) {
+        deliverLoad(replaced[i], false, "Ads::load");
+    }
+    AdHandle handle = request->handle;
+    if(ready) {
+        deliverLoad(request, true, "Ads::load");
+    } else if(start) {
+        startRewardedLoad(handle.serial, adUnit, "Ads::load");
+    }
+    return handle;
+}
+
+///////////////////////////////////////
+//
+//  Ads
+//
+///////////////////////////////////////
+
+void Ads::initialize(const firebase::App& app, const char* appId)
+{
+    ADMOB_SDK_CALL(kSlotNone, "admob::Initialize", NULL, firebase::admob::Initialize(app, appId));
+    initAnalytics(app);
+}
+
+void Ads::addTestDevice(const std::string& deviceId)
+{
+    std::lock_guard<std::mutex> lock(adRequestMutex);
+    std::shared_ptr<AdRequestSnapshot> snapshot = std::make_shared<AdRequestSnapshot>();
+    snapshot->testDeviceIds = my_ad_request->testDeviceIds;
+    snapshot->testDeviceIds.push_back(deviceId);
+    for(size_t i=0; i<snapshot->testDeviceIds.size(); i++) {
+        snapshot->testDevices.push_back(snapshot->testDeviceIds[i].c_str());
+        printLog(snapshot->testDeviceIds[i].c_str());
+    }
+    snapshot->request.test_device_id_count = snapshot->testDevices.size();
+    snapshot->request.test_device_ids = snapshot->testDevices.data();
+    my_ad_request = snapshot;
+}
+
+AdHandle Ads::load(AdFormat format, const char* adUnit, const LoadCallback& done)
+{
+    logAdLifecycle(kLifecycleRequest, format, adUnit, 0);
+    switch(format) {
+        case kAdFormatBanner:
+            return loadBanner(adUnit, done);
+        case kAdFormatInterstitial:
+            return loadInterstitial(adUnit, done);
+        case kAdFormatRewarded:
+        default:
+            return loadRewarded(adUnit, done);
+    }
+}
+
+AdHandle Ads::current(AdFormat format)
+{
+    AdHandle handle = { format, adSerials[format].load() };
+    return handle;
+}
+
+bool Ads::isLoaded(AdHandle ad)
+{
+    if(!isCurrent(ad)) {
+        return false;
+    }
+    switch(ad.format) {
+        case kAdFormatBanner:
+            // published on a successful load, see deliverLoad
+            return sharedBannerView != NULL;
+        case kAdFormatInterstitial:
+            return sharedInterstitialAd != NULL;
+        case kAdFormatRewarded:
+        default:
+            return rewardedStreamState == kRewardedReady;
+    }
+}
+
+bool Ads::show(AdHandle ad, int placement)
+{
+    // caps hold even when JS skips bestAd
+    uint64_t nowMs = traceNow() / 1000;
+    if(!showAllowed(placement, nowMs)) {
+        return false;
+    }
+    switch(ad.format) {
+        case kAdFormatBanner:
+            if(!isLoaded(ad)) {
+                return false;
+            }
+            sharedBannerView->SetListener(&bannerListener);
+            markShown(kAdFormatBanner, bannerAdUnit);
+            ADMOB_SDK_CALL(kSlotBanner, "BannerView::Show", bannerAdUnit, sharedBannerView->Show());
+            break;
+        case kAdFormatInterstitial:
+            if(!isLoaded(ad)) {
+                return false;
+            }
+            // an interstitial shows once; one whose show never got to
+            // hidden is retired here
+            if(shownInterstitialAd != NULL) {
+                retireInterstitial(shownInterstitialAd);
+            }
+            shownInterstitialAd = sharedInterstitialAd;
+            sharedInterstitialAd = NULL;
+            setInventoryReady(kAdInterstitial, false);
+            shownInterstitialAd->SetListener(&interstitialListener);
+            markShown(kAdFormatInterstitial, interstitialAdUnit);
+            ADMOB_SDK_CALL(kSlotInterstitial, "InterstitialAd::Show", interstitialAdUnit, shownInterstitialAd->Show());
+            break;
+        case kAdFormatRewarded:
+        default: {
+            int ready = kRewardedReady;
+            if(!isCurrent(ad) || !rewardedStreamState.compare_exchange_strong(ready, kRewardedShowing)) {
+                return false;
+            }
+            setInventoryReady(kAdRewarded, false);
+            firebase::admob::rewarded_video::SetListener(&rewardedListener);
+            markShown(kAdFormatRewarded, rewardedAdUnit);
+            ADMOB_SDK_CALL(kSlotRewarded, "rewarded_video::Show", rewardedAdUnit, firebase::admob::rewarded_video::Show(platformAdParent()));
+            firebase::admob::rewarded_video::ShowLastResult().OnCompletion(RewardedShowCallback, NULL);
+            break;
+        }
+    }
+    // every show counts against the global caps
+    recordShow(placement, nowMs);
+    return true;
+}
+
+bool Ads::hide(AdHandle ad)
+{
+    if(ad.format != kAdFormatBanner || !isCurrent(ad) ||
+       sharedBannerView == NULL ||
+       sharedBannerView->ShowLastResult().status() != firebase::kFutureStatusComplete ||
+       sharedBannerView->ShowLastResult().error() != firebase::admob::kAdMobErrorNone) {
+        return false;
+    }
+    ADMOB_SDK_CALL(kSlotBanner, "BannerView::Hide", bannerAdUnit, sharedBannerView->Hide());
+    sharedBannerView->HideLastResult().OnCompletion(BannerHideCallback, sharedBannerView);
+    sharedBannerView = NULL;
+    nextHandle(kAdFormatBanner);
+    return true;
+}
+
+void Ads::setEventCallback(AdFormat format, const EventCallback& callback)
+{
+    eventCallbacks[format] = callback;
+}
+
+RewardedState Ads::rewardedState()
+{
+    return (RewardedState)rewardedStreamState.load();
+}
+
+void Ads::setRewardedAutoload(bool enabled)
+{
+    rewardedAutoload = enabled;
+}
+
+} // namespace admob
+} // namespace sdkbar
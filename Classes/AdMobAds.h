@@ -0,0 +1,87 @@
+#ifndef AdMobAds_h
+#define AdMobAds_h
+
+#include <functional>
+#include <stdint.h>
+#include <string>
+#include "firebase/app.h"
+#include "AdMobTrace.h"
+
+namespace sdkbar {
+namespace admob {
+
+// Native AdMob core. Owns the banner, the interstitial and the rewarded video
+// stream; gameplay code uses it directly and the JS bindings are a thin layer
+// on top. Call it from the cocos thread, every callback is delivered there.
+
+enum AdFormat {
+    kAdFormatBanner = kSlotBanner,
+    kAdFormatInterstitial = kSlotInterstitial,
+    kAdFormatRewarded = kSlotRewarded
+};
+
+// One loaded ad object. A handle goes stale once its format is loaded again
+// (or the banner is closed); stale handles are never loaded or shown.
+struct AdHandle {
+    AdFormat format;
+    uint32_t serial;
+};
+
+// rewarded_video is a process-wide singleton, so one state machine tracks
+// the whole rewarded stream. Transitions may happen on SDK threads.
+enum RewardedState {
+    kRewardedIdle = 0,
+    kRewardedInitializing,
+    kRewardedLoading,
+    kRewardedReady,
+    kRewardedShowing,
+    kRewardedConsumed,
+    kRewardedFailed,
+};
+
+enum AdEventType {
+    kAdEventPresentationState,
+    kAdEventReward
+};
+
+struct AdEvent {
+    AdFormat format;
+    AdEventType type;
+    int32_t presentationState;  // kAdEventPresentationState
+    float rewardAmount;         // kAdEventReward
+    int rewardTypeAtom;         // kAdEventReward, see AdMobAtoms.h
+};
+
+typedef std::function<void(AdHandle ad, bool loaded)> LoadCallback;
+typedef std::function<void(const AdEvent& event)> EventCallback;
+
+class Ads {
+public:
+    static void initialize(const firebase::App& app, const char* appId);
+    static void addTestDevice(const std::string& deviceId);
+
+    // adUnit must stay valid for the session, e.g. an interned string.
+    static AdHandle load(AdFormat format, const char* adUnit, const LoadCallback& done);
+    static AdHandle current(AdFormat format);
+    static bool isLoaded(AdHandle ad);
+    // placement is an arbiter placement id the show is also paced by and
+    // counted against, or -1; every show is subject to the global pacing
+    // scope. Returns false without showing when pacing denies it.
+    static bool show(AdHandle ad, int placement = -1);
+    // Banner only; hides and destroys it.
+    static bool hide(AdHandle ad);
+
+    // One callback per format, replaced by the next call.
+    static void setEventCallback(AdFormat format, const EventCallback& callback);
+
+    static RewardedState rewardedState();
+    static void setRewardedAutoload(bool enabled);
+
+private:
+    Ads();
+};
+
+} // namespace admob
+} // namespace sdkbar
+
+#endif /* AdMobAds_h */
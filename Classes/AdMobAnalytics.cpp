@@ -0,0 +1,140 @@
+#include "AdMobAnalytics.h"
+#include <atomic>
+#include "AdMobSpool.h"
+#if ADMOB_ANALYTICS
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include "firebase/analytics.h"
+#include "firebase/analytics/parameter_names.h"
+#include "AdMobPlatform.h"
+#endif
+
+namespace sdkbar {
+namespace admob {
+
+static std::atomic<uint32_t> droppedEvents(0);
+
+#if ADMOB_ANALYTICS
+
+struct LifecycleRecord {
+    uint8_t event;
+    uint8_t format;
+    uint32_t latencyMs;
+    const char *adUnit;
+    double value;
+};
+
+static const size_t kAnalyticsRing = 128;
+// wakes the flush thread early; otherwise it flushes every kAnalyticsFlushSec
+static const size_t kAnalyticsBatch = 16;
+static const int kAnalyticsFlushSec = 30;
+
+static std::mutex analyticsMutex;
+static std::condition_variable analyticsCondition;
+static LifecycleRecord analyticsRing[kAnalyticsRing];
+static size_t analyticsHead = 0;
+static size_t analyticsCount = 0;
+static bool analyticsStarted = false;
+
+// ad_impression and ad_reward are reserved Analytics event names and would
+// be dropped by LogEvent, so every event carries the admob_ prefix.
+static const char *const kLifecycleEventNames[kLifecycleEventCount] = {
+    "admob_request", "admob_fill", "admob_no_fill", "admob_impression", "admob_reward", "admob_close"
+};
+static const char *const kAdFormatNames[] = { "", "banner", "interstitial", "rewarded" };
+
+// Parameters are built on the stack; every string is static or interned, so
+// the Variants reference them without copying.
+static void logRecord(const LifecycleRecord &record)
+{
+    firebase::analytics::Parameter params[4];
+    size_t count = 0;
+    params[count++] = firebase::analytics::Parameter("ad_format", kAdFormatNames[record.format]);
+    if(record.adUnit != NULL) {
+        params[count++] = firebase::analytics::Parameter("ad_unit_id", record.adUnit);
+    }
+    params[count++] = firebase::analytics::Parameter("latency_ms", (int64_t)record.latencyMs);
+    if(record.event == kLifecycleReward) {
+        params[count++] = firebase::analytics::Parameter(firebase::analytics::kParameterValue, record.value);
+    }
+    firebase::analytics::LogEvent(kLifecycleEventNames[record.event], params, count);
+}
+
+static void analyticsLoop()
+{
+    attachPlatformThread();
+    lowerThreadPriority();
+    LifecycleRecord batch[kAnalyticsRing];
+    for(;;) {
+        size_t count = 0;
+        {
+            std::unique_lock<std::mutex> lock(analyticsMutex);
+            analyticsCondition.wait_for(lock, std::chrono::seconds(kAnalyticsFlushSec), [] { return analyticsCount >= kAnalyticsBatch; });
+            count = analyticsCount;
+            for(size_t i = 0; i < count; i++) {
+                batch[i] = analyticsRing[(analyticsHead + i) % kAnalyticsRing];
+            }
+            analyticsHead = (analyticsHead + count) % kAnalyticsRing;
+            analyticsCount = 0;
+        }
+        for(size_t i = 0; i < count; i++) {
+            logRecord(batch[i]);
+        }
+    }
+}
+
+void initAnalytics(const firebase::App& app)
+{
+    std::lock_guard<std::mutex> lock(analyticsMutex);
+    if(analyticsStarted) {
+        return;
+    }
+    firebase::analytics::Initialize(app);
+    // lives for the whole process, like the SDK worker
+    std::thread(analyticsLoop).detach();
+    analyticsStarted = true;
+}
+
+static void queueAnalytics(AdLifecycleEvent event, AdFormat format, const char* adUnit, uint32_t latencyMs, double value)
+{
+    std::lock_guard<std::mutex> lock(analyticsMutex);
+    if(analyticsCount == kAnalyticsRing) {
+        droppedEvents++;
+        return;
+    }
+    LifecycleRecord &record = analyticsRing[(analyticsHead + analyticsCount) % kAnalyticsRing];
+    record.event = (uint8_t)event;
+    record.format = (uint8_t)format;
+    record.latencyMs = latencyMs;
+    record.adUnit = adUnit;
+    record.value = value;
+    if(++analyticsCount == kAnalyticsBatch && analyticsStarted) {
+        analyticsCondition.notify_one();
+    }
+}
+
+#else
+
+void initAnalytics(const firebase::App& app)
+{
+}
+
+#endif
+
+void logAdLifecycle(AdLifecycleEvent event, AdFormat format, const char* adUnit, uint32_t latencyMs, double value)
+{
+    appendSpool((uint8_t)event, (uint8_t)format, adUnit, latencyMs, (float)value);
+#if ADMOB_ANALYTICS
+    queueAnalytics(event, format, adUnit, latencyMs, value);
+#endif
+}
+
+uint32_t analyticsDropped()
+{
+    return droppedEvents.load();
+}
+
+} // namespace admob
+} // namespace sdkbar
@@ -0,0 +1,45 @@
+#ifndef AdMobAnalytics_h
+#define AdMobAnalytics_h
+
+#include <stdint.h>
+#include "firebase/app.h"
+#include "AdMobAds.h"
+
+// Firebase Analytics is not linked by this package. Build with
+// ADMOB_ANALYTICS=1 and link libanalytics.a / firebase_analytics.framework
+// to have the lifecycle events logged; otherwise they only go to the
+// telemetry spool (AdMobSpool.h).
+#ifndef ADMOB_ANALYTICS
+#define ADMOB_ANALYTICS 0
+#endif
+
+namespace sdkbar {
+namespace admob {
+
+// Ad lifecycle events the Ads core reports by itself.
+enum AdLifecycleEvent {
+    kLifecycleRequest = 0,
+    kLifecycleFill,
+    kLifecycleNoFill,
+    kLifecycleImpression,
+    kLifecycleReward,
+    kLifecycleClose,
+    kLifecycleEventCount
+};
+
+// Starts Analytics and the flush thread; no-op without ADMOB_ANALYTICS.
+void initAnalytics(const firebase::App& app);
+
+// Any thread; appends the event to the spool and copies it into a fixed ring
+// that is flushed to Analytics in batches on a low-priority thread. adUnit
+// must stay valid for the session (interned), latency is in milliseconds,
+// value is the reward amount.
+void logAdLifecycle(AdLifecycleEvent event, AdFormat format, const char* adUnit, uint32_t latencyMs, double value = 0);
+
+// Events dropped because the ring was full.
+uint32_t analyticsDropped();
+
+} // namespace admob
+} // namespace sdkbar
+
+#endif /* AdMobAnalytics_h */
@@ -0,0 +1,115 @@
+#include "AdMobArbiter.h"
+#include "AdMobAtoms.h"
+#include "AdMobPacing.h"
+#include <atomic>
+#include <stddef.h>
+
+namespace sdkbar {
+namespace admob {
+
+static const int kMaxPlacements = 32;
+
+struct Placement {
+    int nameAtom;
+    uint32_t kindMask;
+    float floor[kAdKindCount];
+};
+
+static std::atomic<bool> inventory[kAdKindCount];
+static Placement placements[kMaxPlacements];
+static int placementCount = 0;
+
+static Placement* placementAt(int placement)
+{
+    if(placement < 0 || placement >= placementCount) {
+        return NULL;
+    }
+    return &placements[placement];
+}
+
+void setInventoryReady(AdKind kind, bool ready)
+{
+    if(kind > kAdNone && kind < kAdKindCount) {
+        inventory[kind].store(ready);
+    }
+}
+
+bool inventoryReady(AdKind kind)
+{
+    return kind > kAdNone && kind < kAdKindCount && inventory[kind].load();
+}
+
+int definePlacement(int nameAtom, uint32_t kindMask)
+{
+    for(int i = 0; i < placementCount; i++) {
+        if(placements[i].nameAtom == nameAtom) {
+            placements[i].kindMask = kindMask;
+            return i;
+        }
+    }
+    if(placementCount == kMaxPlacements) {
+        return -1;
+    }
+    Placement& p = placements[placementCount];
+    p = Placement();
+    p.nameAtom = nameAtom;
+    p.kindMask = kindMask;
+    attachPacingScope(placementCount, atomString(nameAtom));
+    return placementCount++;
+}
+
+int placementName(int placement)
+{
+    Placement* p = placementAt(placement);
+    return p ? p->nameAtom : -1;
+}
+
+bool setPlacementFloor(int placement, AdKind kind, float ecpm)
+{
+    Placement* p = placementAt(placement);
+    if(p == NULL || kind <= kAdNone || kind >= kAdKindCount) {
+        return false;
+    }
+    p->floor[kind] = ecpm;
+    return true;
+}
+
+AdKind bestAd(int placement, uint64_t nowMs)
+{
+    Placement* p = placementAt(placement);
+    if(p == NULL) {
+        return kAdNone;
+    }
+    if(!showAllowed(placement, nowMs)) {
+        return kAdNone;
+    }
+    AdKind best = kAdNone;
+    for(int kind = kAdNone + 1; kind < kAdKindCount; kind++) {
+        if((p->kindMask & adKindBit((AdKind)kind)) == 0 || !inventory[kind].load()) {
+            continue;
+        }
+        if(best == kAdNone || p->floor[kind] > p->floor[best]) {
+            best = (AdKind)kind;
+        }
+    }
+    return best;
+}
+
+bool showAllowed(int placement, uint64_t nowMs)
+{
+    if(placementAt(placement) != NULL && !pacingAllows(placement, nowMs)) {
+        return false;
+    }
+    return pacingAllows(kPacingGlobal, nowMs);
+}
+
+void recordShow(int placement, uint64_t nowMs)
+{
+    if(placementAt(placement) != NULL) {
+        pacingRecordShow(placement, nowMs);
+    }
+    pacingRecordShow(kPacingGlobal, nowMs);
+}
+
+} // namespace admob
+} // namespace sdkbar
@@ -0,0 +1,46 @@
+#ifndef AdMobArbiter_h
+#define AdMobArbiter_h
+
+#include <stdint.h>
+
+namespace sdkbar {
+namespace admob {
+
+// Show arbiter. Keeps the ready inventory and a compact per-placement table
+// of eCPM floor hints so "which ad now?" is one call. Caps and cooldowns are
+// delegated to the pacing engine (AdMobPacing.h), with placement ids as scopes.
+
+enum AdKind {
+    kAdNone = 0,
+    kAdInterstitial = 1,
+    kAdRewarded = 2,
+    kAdKindCount
+};
+
+// Bit for AdKind in a placement's kind mask.
+inline uint32_t adKindBit(AdKind kind) { return 1u << kind; }
+
+// Ready flags, updated from any thread as loads complete and ads are shown.
+void setInventoryReady(AdKind kind, bool ready);
+bool inventoryReady(AdKind kind);
+
+// Placements are registered once from the cocos thread and identified by
+// their index afterwards. Returns -1 when the table is full.
+int definePlacement(int nameAtom, uint32_t kindMask);
+int placementName(int placement);
+bool setPlacementFloor(int placement, AdKind kind, float ecpm);
+
+// Highest-eCPM ready ad allowed by the placement and global pacing rules
+// right now, or kAdNone.
+AdKind bestAd(int placement, uint64_t nowMs);
+// Whether the global pacing scope and, when placement is a defined
+// placement, that placement allow a show right now.
+bool showAllowed(int placement, uint64_t nowMs);
+// Counts a show against the global pacing scope and, when placement is a
+// defined placement, against that placement too. Call it for every show.
+void recordShow(int placement, uint64_t nowMs);
+
+} // namespace admob
+} // namespace sdkbar
+
+#endif /* AdMobArbiter_h */
@@ -0,0 +1,34 @@
+#include "AdMobAtoms.h"
+#include <deque>
+#include <unordered_map>
+
+namespace sdkbar {
+namespace admob {
+
+// std::deque never moves its elements on push_back, so c_str() pointers
+// handed out by atomString() stay valid.
+static std::deque<std::string> atoms;
+static std::unordered_map<std::string, int> atomIndex;
+
+int internString(const std::string& str)
+{
+    std::unordered_map<std::string, int>::const_iterator it = atomIndex.find(str);
+    if(it != atomIndex.end()) {
+        return it->second;
+    }
+    int atom = (int)atoms.size();
+    atoms.push_back(str);
+    atomIndex[str] = atom;
+    return atom;
+}
+
+const char* atomString(int atom)
+{
+    if(atom < 0 || atom >= (int)atoms.size()) {
+        return NULL;
+    }
+    return atoms[atom].c_str();
+}
+
+} // namespace admob
+} // namespace sdkbar
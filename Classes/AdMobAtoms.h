@@ -0,0 +1,22 @@
+#ifndef AdMobAtoms_h
+#define AdMobAtoms_h
+
+#include <string>
+
+namespace sdkbar {
+namespace admob {
+
+// Intern table for ad unit ids and Remote Config keys.
+// JS registers a string once and passes the returned atom on every later call,
+// so the hot path is an index lookup instead of a string conversion.
+// Must be used from the cocos/JS thread only.
+int internString(const std::string& str);
+
+// Returns the interned string or NULL for an unknown atom. The pointer stays
+// valid for the whole process lifetime.
+const char* atomString(int atom);
+
+} // namespace admob
+} // namespace sdkbar
+
+#endif /* AdMobAtoms_h */
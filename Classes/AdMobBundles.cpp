@@ -0,0 +1,325 @@
+#include "AdMobBundles.h"
+#include <mutex>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include "base/CCDirector.h"
+#include "base/CCScheduler.h"
+#include "AdMobWorker.h"
+#if ADMOB_STORAGE
+#include "firebase/storage.h"
+#endif
+
+namespace sdkbar {
+namespace admob {
+
+// used when fetchBundle runs before configureBundlePool
+static const size_t kDefaultBundleSlots = 2;
+static const size_t kDefaultBundleSlotBytes = 1024 * 1024;
+
+static std::mutex bundleMutex;
+static std::vector<void*> freeBuffers;
+static size_t poolSlots = 0;
+static size_t poolSlotBytes = 0;
+static BundleSource bundleSource;
+// File reads of the file source, off the cocos thread.
+static SerialQueue fileQueue;
+
+struct BundleDigest {
+    uint8_t bytes[32];
+};
+
+///////////////////////////////////////
+//
+//  SHA-256
+//
+///////////////////////////////////////
+
+static const uint32_t kSha256K[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+static uint32_t rotr(uint32_t x, int n)
+{
+    return (x >> n) | (x << (32 - n));
+}
+
+static void sha256Block(uint32_t state[8], const uint8_t block[64])
+{
+    uint32_t w[64];
+    for(int i = 0; i < 16; i++) {
+        w[i] = (uint32_t)block[i * 4] << 24 | (uint32_t)block[i * 4 + 1] << 16 | (uint32_t)block[i * 4 + 2] << 8 | block[i * 4 + 3];
+    }
+    for(int i = 16; i < 64; i++) {
+        uint32_t s0 = rotr(w[i - 15], 7) ^ rotr(w[i - 15], 18) ^ (w[i - 15] >> 3);
+        uint32_t s1 = rotr(w[i - 2], 17) ^ rotr(w[i - 2], 19) ^ (w[i - 2] >> 10);
+        w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+    }
+    uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+    uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
+    for(int i = 0; i < 64; i++) {
+        uint32_t t1 = h + (rotr(e, 6) ^ rotr(e, 11) ^ rotr(e, 25)) + ((e & f) ^ (~e & g)) + kSha256K[i] + w[i];
+        uint32_t t2 = (rotr(a, 2) ^ rotr(a, 13) ^ rotr(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+        h = g; g = f; f = e; e = d + t1;
+        d = c; c = b; b = a; a = t1 + t2;
+    }
+    state[0] += a; state[1] += b; state[2] += c; state[3] += d;
+    state[4] += e; state[5] += f; state[6] += g; state[7] += h;
+}
+
+void sha256(const void* data, size_t size, uint8_t digest[32])
+{
+    uint32_t state[8] = { 0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19 };
+    const uint8_t *bytes = static_cast<const uint8_t*>(data);
+    size_t offset = 0;
+    for(; offset + 64 <= size; offset += 64) {
+        sha256Block(state, bytes + offset);
+    }
+    // padding: 0x80, zeros, then the bit length big-endian
+    uint8_t tail[128];
+    size_t rest = size - offset;
+    memcpy(tail, bytes + offset, rest);
+    tail[rest] = 0x80;
+    size_t tailSize = rest + 9 <= 64 ? 64 : 128;
+    memset(tail + rest + 1, 0, tailSize - rest - 1);
+    uint64_t bits = (uint64_t)size * 8;
+    for(int i = 0; i < 8; i++) {
+        tail[tailSize - 1 - i] = (uint8_t)(bits >> (i * 8));
+    }
+    for(size_t i = 0; i < tailSize; i += 64) {
+        sha256Block(state, tail + i);
+    }
+    for(int i = 0; i < 8; i++) {
+        digest[i * 4] = (uint8_t)(state[i] >> 24);
+        digest[i * 4 + 1] = (uint8_t)(state[i] >> 16);
+        digest[i * 4 + 2] = (uint8_t)(state[i] >> 8);
+        digest[i * 4 + 3] = (uint8_t)state[i];
+    }
+}
+
+static int hexValue(char c)
+{
+    if(c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    if(c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    if(c >= 'A' && c <= 'F') {
+        return c - 'A' + 10;
+    }
+    return -1;
+}
+
+bool parseSha256(const std::string& hex, uint8_t digest[32])
+{
+    if(hex.size() != 64) {
+        return false;
+    }
+    for(int i = 0; i < 32; i++) {
+        int high = hexValue(hex[i * 2]);
+        int low = hexValue(hex[i * 2 + 1]);
+        if(high < 0 || low < 0) {
+            return false;
+        }
+        digest[i] = (uint8_t)(high << 4 | low);
+    }
+    return true;
+}
+
+///////////////////////////////////////
+//
+//  Buffer Pool
+//
+///////////////////////////////////////
+
+// bundleMutex held
+static void preallocate(size_t slots, size_t slotBytes)
+{
+    poolSlots = slots;
+    poolSlotBytes = slotBytes;
+    for(size_t i = 0; i < slots; i++) {
+        void *buffer = malloc(slotBytes);
+        if(buffer == NULL) {
+            break;
+        }
+        freeBuffers.push_back(buffer);
+    }
+}
+
+bool configureBundlePool(size_t slots, size_t slotBytes)
+{
+    std::lock_guard<std::mutex> lock(bundleMutex);
+    if(poolSlotBytes != 0 || slots == 0 || slotBytes == 0) {
+        return false;
+    }
+    preallocate(slots, slotBytes);
+    return true;
+}
+
+// Falls back to a fresh allocation while every pooled buffer is handed out.
+static void* acquireBuffer(size_t *capacity)
+{
+    std::lock_guard<std::mutex> lock(bundleMutex);
+    if(poolSlotBytes == 0) {
+        preallocate(kDefaultBundleSlots, kDefaultBundleSlotBytes);
+    }
+    *capacity = poolSlotBytes;
+    if(freeBuffers.empty()) {
+        return malloc(poolSlotBytes);
+    }
+    void *buffer = freeBuffers.back();
+    freeBuffers.pop_back();
+    return buffer;
+}
+
+void releaseBundleBuffer(void* data)
+{
+    if(data == NULL) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(bundleMutex);
+    if(freeBuffers.size() >= poolSlots) {
+        free(data);
+        return;
+    }
+    // no-op for pool buffers; contents stolen from a shrunk ArrayBuffer grow back
+    void *buffer = realloc(data, poolSlotBytes);
+    if(buffer == NULL) {
+        free(data);
+        return;
+    }
+    freeBuffers.push_back(buffer);
+}
+
+///////////////////////////////////////
+//
+//  Fetch
+//
+///////////////////////////////////////
+
+void setBundleSource(const BundleSource& source)
+{
+    std::lock_guard<std::mutex> lock(bundleMutex);
+    bundleSource = source;
+}
+
+// The digest is checked on the source's completion thread, only the result
+// hops to the cocos thread.
+bool fetchBundle(const char* path, const uint8_t sha256Digest[32], const BundleCallback& done)
+{
+    BundleSource source;
+    {
+        std::lock_guard<std::mutex> lock(bundleMutex);
+        source = bundleSource;
+    }
+    size_t capacity = 0;
+    void *buffer = source ? acquireBuffer(&capacity) : NULL;
+    if(buffer == NULL) {
+        BundleError error = source ? kBundleTooLarge : kBundleNoSource;
+        cocos2d::Director::getInstance()->getScheduler()->performFunctionInCocosThread([error, done] {
+                done(error, NULL, 0);
+            });
+        return false;
+    }
+    BundleDigest expected;
+    memcpy(expected.bytes, sha256Digest, sizeof(expected.bytes));
+    source(path, buffer, capacity, [buffer, capacity, expected, done](bool ok, size_t size) {
+            BundleError error = kBundleOk;
+            if(!ok) {
+                error = kBundleDownloadFailed;
+            } else if(size >= capacity) {
+                // a full buffer may be a truncated download
+                error = kBundleTooLarge;
+            } else {
+                BundleDigest actual;
+                sha256(buffer, size, actual.bytes);
+                if(memcmp(actual.bytes, expected.bytes, sizeof(actual.bytes)) != 0) {
+                    error = kBundleHashMismatch;
+                }
+            }
+            if(error != kBundleOk) {
+                releaseBundleBuffer(buffer);
+            }
+            cocos2d::Director::getInstance()->getScheduler()->performFunctionInCocosThread([error, buffer, size, done] {
+                    if(error == kBundleOk) {
+                        done(kBundleOk, buffer, size);
+                    } else {
+                        done(error, NULL, 0);
+                    }
+                });
+        });
+    return true;
+}
+
+void useFileBundleSource(const std::string& rootDir)
+{
+    std::string root = rootDir;
+    if(!root.empty() && root[root.size() - 1] != '/') {
+        root += '/';
+    }
+    setBundleSource([root](const char* path, void* buffer, size_t capacity, const BundleSourceDone& done) {
+            std::string fullPath = root + path;
+            fileQueue.post([fullPath, buffer, capacity, done] {
+                    FILE *file = fopen(fullPath.c_str(), "rb");
+                    if(file == NULL) {
+                        done(false, 0);
+                        return;
+                    }
+                    // a file filling the buffer is reported as too large
+                    size_t size = fread(buffer, 1, capacity, file);
+                    bool ok = !ferror(file);
+                    fclose(file);
+                    done(ok, size);
+                });
+        });
+}
+
+#if ADMOB_STORAGE
+
+struct StorageFetch {
+    firebase::storage::StorageReference reference;
+    BundleSourceDone done;
+};
+
+static void StorageFetchCallback(const firebase::Future<size_t>& future, void* user_data) {
+    StorageFetch *fetch = static_cast<StorageFetch*>(user_data);
+    bool ok = future.error() == firebase::storage::kErrorNone && future.result() != NULL;
+    fetch->done(ok, ok ? *future.result() : 0);
+    delete fetch;
+}
+
+bool useStorageBundleSource(firebase::App* app)
+{
+    firebase::storage::Storage *storage = firebase::storage::Storage::GetInstance(app);
+    if(storage == NULL) {
+        return false;
+    }
+    setBundleSource([storage](const char* path, void* buffer, size_t capacity, const BundleSourceDone& done) {
+            StorageFetch *fetch = new StorageFetch();
+            fetch->reference = storage->GetReference(path);
+            fetch->done = done;
+            fetch->reference.GetBytes(buffer, capacity).OnCompletion(StorageFetchCallback, fetch);
+        });
+    return true;
+}
+
+#else
+
+bool useStorageBundleSource(firebase::App* app)
+{
+    return false;
+}
+
+#endif
+
+} // namespace admob
+} // namespace sdkbar
@@ -0,0 +1,68 @@
+#ifndef AdMobBundles_h
+#define AdMobBundles_h
+
+#include <functional>
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include "firebase/app.h"
+
+// Firebase Storage is not linked by this package. Build with ADMOB_STORAGE=1
+// and link libstorage.a / firebase_storage.framework to fetch bundles from
+// Storage; otherwise a source has to be set with setBundleSource().
+#ifndef ADMOB_STORAGE
+#define ADMOB_STORAGE 0
+#endif
+
+namespace sdkbar {
+namespace admob {
+
+// Tuning bundles too large for Remote Config. Each bundle is downloaded into
+// a buffer from a preallocated pool, checked against its SHA-256 and handed
+// over as is; the receiver returns the buffer with releaseBundleBuffer() so
+// the next download reuses it instead of allocating.
+
+enum BundleError {
+    kBundleOk = 0,
+    kBundleNoSource,
+    kBundleDownloadFailed,
+    kBundleTooLarge,       // did not fit a pool buffer
+    kBundleHashMismatch
+};
+
+// Downloads path into buffer and reports the size; done may run on any
+// thread. The default source is Firebase Storage (ADMOB_STORAGE); desktop
+// builds and tests can read from disk or memory instead.
+typedef std::function<void(bool ok, size_t size)> BundleSourceDone;
+typedef std::function<void(const char* path, void* buffer, size_t capacity, const BundleSourceDone& done)> BundleSource;
+
+// Cocos thread. data stays valid until released, and is NULL on error.
+typedef std::function<void(BundleError error, void* data, size_t size)> BundleCallback;
+
+// Preallocates slots buffers of slotBytes each. The first call sizes the
+// pool for the session; later calls return false.
+bool configureBundlePool(size_t slots, size_t slotBytes);
+
+void setBundleSource(const BundleSource& source);
+// Selects the Storage source for app; false without ADMOB_STORAGE.
+bool useStorageBundleSource(firebase::App* app);
+// Selects a source reading path below rootDir from disk on the worker
+// thread, for desktop builds and bundles shipped in the app.
+void useFileBundleSource(const std::string& rootDir);
+
+// done always runs once; false when the download could not be started.
+bool fetchBundle(const char* path, const uint8_t sha256[32], const BundleCallback& done);
+
+// Any thread. data must come from malloc (a fetched bundle, or the contents
+// stolen back from its ArrayBuffer); it is resized to the slot size if needed
+// and kept for the next download, or freed when the pool is full.
+void releaseBundleBuffer(void* data);
+
+void sha256(const void* data, size_t size, uint8_t digest[32]);
+// 64 hex digits; false when malformed.
+bool parseSha256(const std::string& hex, uint8_t digest[32]);
+
+} // namespace admob
+} // namespace sdkbar
+
+#endif /* AdMobBundles_h */
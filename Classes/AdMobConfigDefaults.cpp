@@ -0,0 +1,90 @@
+#include "AdMobConfigDefaults.h"
+#include <stdint.h>
+#include <string.h>
+
+namespace sdkbar {
+namespace admob {
+
+static const uint32_t kConfigDefaultsVersion = 1;
+static const size_t kHeaderSize = 16;
+static const size_t kEntrySize = 16;
+
+static uint32_t readU32(const unsigned char* p)
+{
+    uint32_t value;
+    memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+static uint64_t readU64(const unsigned char* p)
+{
+    uint64_t value;
+    memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+// Pool string at offset, or NULL when it is out of range or unterminated.
+static const char* poolString(const unsigned char* pool, size_t poolSize, uint64_t offset)
+{
+    if(offset >= poolSize || memchr(pool + offset, '\0', poolSize - offset) == NULL) {
+        return NULL;
+    }
+    return reinterpret_cast<const char*>(pool + offset);
+}
+
+bool parseConfigDefaults(const void* data, size_t size, std::vector<firebase::remote_config::ConfigKeyValueVariant>* out)
+{
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    if(bytes == NULL || size < kHeaderSize || memcmp(bytes, "ARCD", 4) != 0 ||
+       readU32(bytes + 4) != kConfigDefaultsVersion) {
+        return false;
+    }
+    uint32_t count = readU32(bytes + 8);
+    uint32_t poolOffset = readU32(bytes + 12);
+    if(poolOffset < kHeaderSize || poolOffset > size || (poolOffset - kHeaderSize) / kEntrySize < count) {
+        return false;
+    }
+    const unsigned char* pool = bytes + poolOffset;
+    size_t poolSize = size - poolOffset;
+
+    out->clear();
+    out->reserve(count);
+    for(uint32_t i = 0; i < count; i++) {
+        const unsigned char* entry = bytes + kHeaderSize + i * kEntrySize;
+        uint64_t raw = readU64(entry + 8);
+        firebase::remote_config::ConfigKeyValueVariant item;
+        item.key = poolString(pool, poolSize, readU32(entry));
+        if(item.key == NULL) {
+            return false;
+        }
+        switch(entry[4]) {
+            case kConfigDefaultBool:
+                item.value = firebase::Variant::FromBool(raw != 0);
+                break;
+            case kConfigDefaultInt64:
+                item.value = firebase::Variant::FromInt64((int64_t)raw);
+                break;
+            case kConfigDefaultDouble: {
+                double value;
+                memcpy(&value, &raw, sizeof(value));
+                item.value = firebase::Variant::FromDouble(value);
+                break;
+            }
+            case kConfigDefaultString: {
+                const char* value = poolString(pool, poolSize, raw);
+                if(value == NULL) {
+                    return false;
+                }
+                item.value = firebase::Variant::FromStaticString(value);
+                break;
+            }
+            default:
+                return false;
+        }
+        out->push_back(item);
+    }
+    return true;
+}
+
+} // namespace admob
+} // namespace sdkbar
@@ -0,0 +1,36 @@
+#ifndef AdMobConfigDefaults_h
+#define AdMobConfigDefaults_h
+
+#include <stddef.h>
+#include <vector>
+#include "firebase/remote_config.h"
+
+namespace sdkbar {
+namespace admob {
+
+// Remote Config defaults blob, built by tools/build_config_defaults.py.
+// Little-endian layout:
+//
+//   header   "ARCD", u32 version (1), u32 entry count, u32 string pool offset
+//   entries  u32 key offset, u8 type, u8[3] padding, u64 value
+//   pool     NUL-terminated keys and string values
+//
+// Offsets in entries are relative to the pool. bool and int64 values are
+// stored as integers, doubles as their IEEE bits, strings as a pool offset.
+
+enum ConfigDefaultType {
+    kConfigDefaultBool = 0,
+    kConfigDefaultInt64 = 1,
+    kConfigDefaultDouble = 2,
+    kConfigDefaultString = 3
+};
+
+// Fills out with one entry per default. Keys and string values point into
+// data (Variant::FromStaticString), so data must outlive out. Returns false
+// on a malformed blob.
+bool parseConfigDefaults(const void* data, size_t size, std::vector<firebase::remote_config::ConfigKeyValueVariant>* out);
+
+} // namespace admob
+} // namespace sdkbar
+
+#endif /* AdMobConfigDefaults_h */
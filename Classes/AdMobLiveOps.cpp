@@ -0,0 +1,189 @@
+#include "AdMobLiveOps.h"
+#if ADMOB_LIVE_OPS
+#include <mutex>
+#include <set>
+#include "base/CCDirector.h"
+#include "base/CCScheduler.h"
+#include "firebase/database.h"
+#endif
+
+namespace sdkbar {
+namespace admob {
+
+// Cocos thread only.
+static LiveOpsTree liveTree;
+
+#if ADMOB_LIVE_OPS
+
+// Written by SDK listener threads, drained once per frame on the cocos thread.
+static std::mutex pendingMutex;
+static LiveOpsTree pendingChanged;
+static std::set<std::string> pendingRemoved;
+static bool pendingConnected = false;
+static bool flushScheduled = false;
+
+// Cocos thread only.
+static LiveOpsCallback diffCallback;
+static bool deliveredConnected = false;
+static firebase::database::DatabaseReference liveRef;
+static firebase::database::DatabaseReference connectedRef;
+
+static void printLog(const char* str) {
+    CCLOG("%s", str);
+}
+
+static void flushDiff()
+{
+    LiveOpsTree changed;
+    std::vector<std::string> removed;
+    bool connected = false;
+    {
+        std::lock_guard<std::mutex> lock(pendingMutex);
+        changed.swap(pendingChanged);
+        removed.assign(pendingRemoved.begin(), pendingRemoved.end());
+        pendingRemoved.clear();
+        connected = pendingConnected;
+        flushScheduled = false;
+    }
+    if(changed.empty() && removed.empty() && connected == deliveredConnected) {
+        return;
+    }
+    for(size_t i = 0; i < removed.size(); i++) {
+        liveTree.erase(removed[i]);
+    }
+    for(LiveOpsTree::const_iterator it = changed.begin(); it != changed.end(); ++it) {
+        liveTree[it->first] = it->second;
+    }
+    deliveredConnected = connected;
+    // a copy, the callback may stop or restart the channel
+    LiveOpsCallback callback = diffCallback;
+    if(callback) {
+        callback(changed, removed, connected);
+    }
+}
+
+// pendingMutex held; at most one flush is queued, so a burst of events
+// becomes one diff on the next frame.
+static void scheduleFlush()
+{
+    if(!flushScheduled) {
+        flushScheduled = true;
+        cocos2d::Director::getInstance()->getScheduler()->performFunctionInCocosThread(flushDiff);
+    }
+}
+
+static void childChanged(const firebase::database::DataSnapshot& snapshot)
+{
+    // converted by the SDK outside the lock
+    firebase::Variant value = snapshot.value();
+    std::lock_guard<std::mutex> lock(pendingMutex);
+    std::string key = snapshot.key_string();
+    pendingRemoved.erase(key);
+    pendingChanged[key] = std::move(value);
+    scheduleFlush();
+}
+
+static void childRemoved(const firebase::database::DataSnapshot& snapshot)
+{
+    std::lock_guard<std::mutex> lock(pendingMutex);
+    std::string key = snapshot.key_string();
+    pendingChanged.erase(key);
+    pendingRemoved.insert(key);
+    scheduleFlush();
+}
+
+class LiveOpsChildListener : public firebase::database::ChildListener {
+public:
+    void OnChildAdded(const firebase::database::DataSnapshot& snapshot, const char* previous_sibling_key) override {
+        childChanged(snapshot);
+    }
+
+    void OnChildChanged(const firebase::database::DataSnapshot& snapshot, const char* previous_sibling_key) override {
+        childChanged(snapshot);
+    }
+
+    void OnChildMoved(const firebase::database::DataSnapshot& snapshot, const char* previous_sibling_key) override {
+        // the tree is keyed, child order does not matter
+    }
+
+    void OnChildRemoved(const firebase::database::DataSnapshot& snapshot) override {
+        childRemoved(snapshot);
+    }
+
+    void OnCancelled(const firebase::database::Error& error, const char* error_message) override {
+        printLog("[AdMob] live ops listener cancelled");
+        printLog(error_message);
+    }
+};
+
+class LiveOpsConnectedListener : public firebase::database::ValueListener {
+public:
+    void OnValueChanged(const firebase::database::DataSnapshot& snapshot) override {
+        firebase::Variant value = snapshot.value();
+        std::lock_guard<std::mutex> lock(pendingMutex);
+        pendingConnected = value.is_bool() && value.bool_value();
+        scheduleFlush();
+    }
+
+    void OnCancelled(const firebase::database::Error& error, const char* error_message) override {
+        printLog("[AdMob] live ops connection listener cancelled");
+    }
+};
+
+static LiveOpsChildListener childListener;
+static LiveOpsConnectedListener connectedListener;
+
+bool startLiveOps(firebase::App* app, const char* path, const LiveOpsCallback& onDiff)
+{
+    stopLiveOps();
+    firebase::database::Database *database = firebase::database::Database::GetInstance(app);
+    if(database == NULL) {
+        return false;
+    }
+    diffCallback = onDiff;
+    liveRef = database->GetReference(path);
+    liveRef.AddChildListener(&childListener);
+    connectedRef = database->GetReference(".info/connected");
+    connectedRef.AddValueListener(&connectedListener);
+    return true;
+}
+
+void stopLiveOps()
+{
+    if(liveRef.is_valid()) {
+        liveRef.RemoveChildListener(&childListener);
+        connectedRef.RemoveValueListener(&connectedListener);
+    }
+    liveRef = firebase::database::DatabaseReference();
+    connectedRef = firebase::database::DatabaseReference();
+    {
+        std::lock_guard<std::mutex> lock(pendingMutex);
+        pendingChanged.clear();
+        pendingRemoved.clear();
+        pendingConnected = false;
+    }
+    diffCallback = nullptr;
+    deliveredConnected = false;
+    liveTree.clear();
+}
+
+#else
+
+bool startLiveOps(firebase::App* app, const char* path, const LiveOpsCallback& onDiff)
+{
+    return false;
+}
+
+void stopLiveOps()
+{
+}
+
+#endif
+
+const LiveOpsTree& liveOpsTree()
+{
+    return liveTree;
+}
+
+} // namespace admob
+} // namespace sdkbar
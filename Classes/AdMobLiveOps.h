@@ -0,0 +1,44 @@
+#ifndef AdMobLiveOps_h
+#define AdMobLiveOps_h
+
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+#include "firebase/app.h"
+#include "firebase/variant.h"
+
+// Firebase Realtime Database is not linked by this package. Build with
+// ADMOB_LIVE_OPS=1 and link libdatabase.a / firebase_database.framework to
+// enable the channel; otherwise startLiveOps() returns false.
+#ifndef ADMOB_LIVE_OPS
+#define ADMOB_LIVE_OPS 0
+#endif
+
+namespace sdkbar {
+namespace admob {
+
+// Live-ops config channel. A ChildListener on one Realtime Database path
+// keeps an in-memory tree of its direct children; SDK events are coalesced
+// and delivered as one diff per frame on the cocos thread, carrying only the
+// children that changed since the previous diff. The first diff holds every
+// child. A child that changes is sent whole, so subscribe to the deepest path
+// that still covers the event.
+
+typedef std::map<std::string, firebase::Variant> LiveOpsTree;
+
+// changed: new value of each added or changed child; removed: keys of
+// deleted children; connected: the client's .info/connected state.
+typedef std::function<void(const LiveOpsTree& changed, const std::vector<std::string>& removed, bool connected)> LiveOpsCallback;
+
+// One path at a time; a new call replaces the previous subscription.
+bool startLiveOps(firebase::App* app, const char* path, const LiveOpsCallback& onDiff);
+void stopLiveOps();
+
+// Cocos thread; the tree as of the last delivered diff.
+const LiveOpsTree& liveOpsTree();
+
+} // namespace admob
+} // namespace sdkbar
+
+#endif /* AdMobLiveOps_h */
@@ -0,0 +1,245 @@
+#include "AdMobPacing.h"
+#include <map>
+#include <stdio.h>
+#include <time.h>
+#include "AdMobWorker.h"
+
+namespace sdkbar {
+namespace admob {
+
+// Placement ids 0..kMaxPacingScopes-2, the last slot is the global scope.
+static const int kMaxPacingScopes = 33;
+
+struct DailyCount {
+    int64_t day;
+    uint32_t shows;
+};
+
+struct PacingScope {
+    PacingRule rule;
+    std::string name;
+    uint32_t sessionShows;
+    DailyCount daily;
+    uint64_t ring[kPacingRing];
+    uint32_t ringCount;
+};
+
+typedef std::map<std::string, DailyCount> StoredCounts;
+
+static PacingScope scopes[kMaxPacingScopes];
+static std::string storePath;
+static StoredCounts storedCounts;
+// Store rewrites run on the AdMob worker, in order.
+static SerialQueue storeQueue;
+
+static PacingScope* scopeAt(int scope)
+{
+    if(scope == kPacingGlobal) {
+        return &scopes[kMaxPacingScopes - 1];
+    }
+    if(scope < 0 || scope >= kMaxPacingScopes - 1) {
+        return NULL;
+    }
+    return &scopes[scope];
+}
+
+static int64_t today()
+{
+    return (int64_t)time(NULL) / 86400;
+}
+
+// Names are written with '%', whitespace and control characters
+// percent-encoded, so every line reads "<name> <day> <shows>".
+static std::string escapeName(const std::string& name)
+{
+    static const char hex[] = "0123456789ABCDEF";
+    std::string out;
+    for(size_t i = 0; i < name.size(); i++) {
+        unsigned char c = (unsigned char)name[i];
+        if(c <= ' ' || c == '%' || c == 0x7f) {
+            out += '%';
+            out += hex[c >> 4];
+            out += hex[c & 0xf];
+        } else {
+            out += (char)c;
+        }
+    }
+    return out;
+}
+
+static int hexDigit(char c)
+{
+    if(c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    if(c >= 'A' && c <= 'F') {
+        return c - 'A' + 10;
+    }
+    return -1;
+}
+
+static bool unescapeName(const std::string& escaped, std::string* name)
+{
+    name->clear();
+    for(size_t i = 0; i < escaped.size(); i++) {
+        if(escaped[i] != '%') {
+            *name += escaped[i];
+            continue;
+        }
+        int high = i + 2 < escaped.size() ? hexDigit(escaped[i + 1]) : -1;
+        int low = i + 2 < escaped.size() ? hexDigit(escaped[i + 2]) : -1;
+        if(high < 0 || low < 0) {
+            return false;
+        }
+        *name += (char)(high << 4 | low);
+        i += 2;
+    }
+    return true;
+}
+
+static void writeStore(const std::string& path, const StoredCounts& counts)
+{
+    std::string tmpPath = path + ".tmp";
+    FILE* file = fopen(tmpPath.c_str(), "w");
+    if(file == NULL) {
+        return;
+    }
+    for(StoredCounts::const_iterator it = counts.begin(); it != counts.end(); ++it) {
+        fprintf(file, "%s %lld %u\n", escapeName(it->first).c_str(), (long long)it->second.day, it->second.shows);
+    }
+    if(fclose(file) == 0) {
+        rename(tmpPath.c_str(), path.c_str());
+    }
+}
+
+// The counters are copied so the cocos thread never waits on the file.
+static void saveStore()
+{
+    if(storePath.empty()) {
+        return;
+    }
+    std::string path = storePath;
+    StoredCounts counts = storedCounts;
+    storeQueue.post([path, counts] {
+            writeStore(path, counts);
+        });
+}
+
+void setPacingStore(const std::string& path)
+{
+    storePath = path;
+    storedCounts.clear();
+    FILE* file = fopen(path.c_str(), "r");
+    if(file == NULL) {
+        return;
+    }
+    std::string contents;
+    char chunk[512];
+    size_t read = 0;
+    while((read = fread(chunk, 1, sizeof(chunk), file)) > 0) {
+        contents.append(chunk, read);
+    }
+    fclose(file);
+    size_t lineStart = 0;
+    while(lineStart < contents.size()) {
+        size_t lineEnd = contents.find('\n', lineStart);
+        if(lineEnd == std::string::npos) {
+            lineEnd = contents.size();
+        }
+        std::string line = contents.substr(lineStart, lineEnd - lineStart);
+        lineStart = lineEnd + 1;
+        size_t separator = line.find(' ');
+        std::string name;
+        long long day = 0;
+        unsigned shows = 0;
+        if(separator == std::string::npos || !unescapeName(line.substr(0, separator), &name) ||
+           sscanf(line.c_str() + separator + 1, "%lld %u", &day, &shows) != 2) {
+            continue;
+        }
+        DailyCount count = { day, shows };
+        storedCounts[name] = count;
+    }
+    for(int i = 0; i < kMaxPacingScopes; i++) {
+        if(!scopes[i].name.empty() && storedCounts.count(scopes[i].name)) {
+            scopes[i].daily = storedCounts[scopes[i].name];
+        }
+    }
+}
+
+void attachPacingScope(int scope, const char* name)
+{
+    PacingScope* s = scopeAt(scope);
+    if(s == NULL || name == NULL || s->name == name) {
+        return;
+    }
+    s->name = name;
+    StoredCounts::const_iterator it = storedCounts.find(s->name);
+    if(it != storedCounts.end()) {
+        s->daily = it->second;
+    }
+}
+
+PacingRule pacingRule(int scope)
+{
+    PacingScope* s = scopeAt(scope);
+    return s ? s->rule : PacingRule();
+}
+
+bool setPacingRule(int scope, const PacingRule& rule)
+{
+    PacingScope* s = scopeAt(scope);
+    if(s == NULL || rule.burstCap > kPacingRing) {
+        return false;
+    }
+    s->rule = rule;
+    return true;
+}
+
+bool pacingAllows(int scope, uint64_t nowMs)
+{
+    PacingScope* s = scopeAt(scope);
+    if(s == NULL) {
+        return false;
+    }
+    const PacingRule& rule = s->rule;
+    if(rule.sessionCap > 0 && s->sessionShows >= rule.sessionCap) {
+        return false;
+    }
+    if(rule.dailyCap > 0 && s->daily.day == today() && s->daily.shows >= rule.dailyCap) {
+        return false;
+    }
+    if(rule.minIntervalSec > 0 && s->ringCount > 0 &&
+       nowMs - s->ring[(s->ringCount - 1) % kPacingRing] < (uint64_t)rule.minIntervalSec * 1000) {
+        return false;
+    }
+    // the show burstCap back must have left the window
+    if(rule.burstCap > 0 && s->ringCount >= rule.burstCap &&
+       nowMs - s->ring[(s->ringCount - rule.burstCap) % kPacingRing] < (uint64_t)rule.burstWindowSec * 1000) {
+        return false;
+    }
+    return true;
+}
+
+void pacingRecordShow(int scope, uint64_t nowMs)
+{
+    PacingScope* s = scopeAt(scope);
+    if(s == NULL) {
+        return;
+    }
+    s->sessionShows++;
+    s->ring[s->ringCount % kPacingRing] = nowMs;
+    s->ringCount++;
+    int64_t day = today();
+    if(s->daily.day != day) {
+        s->daily.day = day;
+        s->daily.shows = 0;
+    }
+    s->daily.shows++;
+    if(!s->name.empty()) {
+        storedCounts[s->name] = s->daily;
+        saveStore();
+    }
+}
+
+} // namespace admob
+} // namespace sdkbar
@@ -0,0 +1,44 @@
+#ifndef AdMobPacing_h
+#define AdMobPacing_h
+
+#include <stdint.h>
+#include <string>
+
+namespace sdkbar {
+namespace admob {
+
+// Frequency capping and pacing. Each scope (a placement id from the arbiter,
+// or the global scope covering every show) has one rule, checked in O(1)
+// against a small ring of its recent show timestamps. Cocos thread only.
+
+static const int kPacingGlobal = -1;
+static const uint32_t kPacingRing = 8;
+
+// Zero disables a limit.
+struct PacingRule {
+    uint32_t sessionCap;      // shows per process lifetime
+    uint32_t minIntervalSec;  // seconds between two shows
+    uint32_t dailyCap;        // shows per UTC day, persisted
+    uint32_t burstCap;        // at most burstCap shows (<= kPacingRing)...
+    uint32_t burstWindowSec;  // ...within this many seconds
+    PacingRule() : sessionCap(0), minIntervalSec(0), dailyCap(0), burstCap(0), burstWindowSec(0) {}
+};
+
+// Daily counters are kept in this file across launches. Loads it now and
+// rewrites it on the AdMob worker thread after every show.
+void setPacingStore(const std::string& path);
+
+// Names a scope so its daily counter survives restarts; placement ids are
+// not stable across launches, names are.
+void attachPacingScope(int scope, const char* name);
+
+PacingRule pacingRule(int scope);
+bool setPacingRule(int scope, const PacingRule& rule);
+
+bool pacingAllows(int scope, uint64_t nowMs);
+void pacingRecordShow(int scope, uint64_t nowMs);
+
+} // namespace admob
+} // namespace sdkbar
+
+#endif /* AdMobPacing_h */
@@ -0,0 +1,33 @@
+#ifndef AdMobPlatform_h
+#define AdMobPlatform_h
+
+#include <string>
+#include "firebase/app.h"
+#include "firebase/admob/types.h"
+
+namespace sdkbar {
+namespace admob {
+
+// Platform shim; exactly one implementation is linked per target:
+// AdMobPlatformAndroid.cpp (JNI), AdMobPlatformIOS.mm (UIKit) or
+// AdMobPlatformHost.cpp, a stub for building the shared code on a desktop.
+
+firebase::App* createFirebaseApp();
+
+// View (iOS) or Activity (Android) that ads are attached to.
+firebase::admob::AdParent platformAdParent();
+
+// Prepares a thread started by the plugin (the SDK worker) for SDK calls.
+void attachPlatformThread();
+
+// Moves the calling background thread (e.g. the analytics flusher) below the
+// render thread's priority.
+void lowerThreadPriority();
+
+// Opens the mediation test suite; false when unavailable.
+bool launchMediationTestSuite(const std::string& appId);
+
+} // namespace admob
+} // namespace sdkbar
+
+#endif /* AdMobPlatform_h */
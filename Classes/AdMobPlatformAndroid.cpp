@@ -0,0 +1,47 @@
+#include "AdMobPlatform.h"
+#include "platform/android/jni/JniHelper.h"
+#include <jni.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+namespace sdkbar {
+namespace admob {
+
+firebase::App* createFirebaseApp()
+{
+    return firebase::App::Create(firebase::AppOptions(), cocos2d::JniHelper::getEnv(), cocos2d::JniHelper::getActivity());
+}
+
+firebase::admob::AdParent platformAdParent()
+{
+    // Returns the Android Activity.
+    return cocos2d::JniHelper::getActivity();
+}
+
+void attachPlatformThread()
+{
+    // attaches the thread to the JVM for the SDK's JNI calls
+    cocos2d::JniHelper::getEnv();
+}
+
+void lowerThreadPriority()
+{
+    // Android threads are scheduled by their own nice value
+    setpriority(PRIO_PROCESS, gettid(), 10);
+}
+
+bool launchMediationTestSuite(const std::string& appId)
+{
+    cocos2d::JniMethodInfo methodInfo;
+    if (! cocos2d::JniHelper::getStaticMethodInfo(methodInfo, "com/google/android/ads/mediationtestsuite/MediationTestSuite", "launch", "(Landroid/content/Context;Ljava/lang/String;)V")) {
+        return false;
+    }
+    jstring str = methodInfo.env->NewStringUTF(appId.c_str());
+    methodInfo.env->CallStaticVoidMethod(methodInfo.classID, methodInfo.methodID, cocos2d::JniHelper::getActivity(), str);
+    methodInfo.env->DeleteLocalRef(str);
+    methodInfo.env->DeleteLocalRef(methodInfo.classID);
+    return true;
+}
+
+} // namespace admob
+} // namespace sdkbar
@@ -0,0 +1,33 @@
+#include "AdMobPlatform.h"
+
+// Desktop stub so the shared code can be built and benchmarked on a host
+// against the Firebase desktop libraries. Not part of the plugin package.
+
+namespace sdkbar {
+namespace admob {
+
+firebase::App* createFirebaseApp()
+{
+    return firebase::App::Create(firebase::AppOptions());
+}
+
+firebase::admob::AdParent platformAdParent()
+{
+    return NULL;
+}
+
+void attachPlatformThread()
+{
+}
+
+void lowerThreadPriority()
+{
+}
+
+bool launchMediationTestSuite(const std::string& appId)
+{
+    return false;
+}
+
+} // namespace admob
+} // namespace sdkbar
@@ -0,0 +1,36 @@
+#import <Foundation/Foundation.h>
+#include "AdMobPlatform.h"
+#include "cocos2d.h"
+#include <pthread.h>
+
+namespace sdkbar {
+namespace admob {
+
+firebase::App* createFirebaseApp()
+{
+    return firebase::App::Create(firebase::AppOptions());
+}
+
+firebase::admob::AdParent platformAdParent()
+{
+    // Returns the iOS RootViewController's main view (i.e. the EAGLView).
+    return (id)cocos2d::Director::getInstance()->getOpenGLView()->getEAGLView();
+}
+
+void attachPlatformThread()
+{
+}
+
+void lowerThreadPriority()
+{
+    pthread_set_qos_class_self_np(QOS_CLASS_UTILITY, 0);
+}
+
+bool launchMediationTestSuite(const std::string& appId)
+{
+    // the mediation test suite is not bundled for iOS
+    return false;
+}
+
+} // namespace admob
+} // namespace sdkbar
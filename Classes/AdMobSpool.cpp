@@ -0,0 +1,158 @@
+#include "AdMobSpool.h"
+#include <atomic>
+#include <chrono>
+#include <fcntl.h>
+#include <mutex>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace sdkbar {
+namespace admob {
+
+// The file is a header followed by a ring of kSpoolCapacity records. Sequence
+// n lives in slot n % kSpoolCapacity; the records still to upload are
+// ackedSequence .. nextSequence-1. Appending only writes a free slot and
+// acknowledging is a single aligned header store, so a crash at any point
+// leaves either the old or the new state, and a torn record fails its
+// checksum and ends the valid run when the file is reopened.
+struct SpoolHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t recordSize;
+    uint32_t capacity;
+    uint32_t ackedSequence;
+    uint32_t reserved[3];
+};
+
+static const char kSpoolMagic[4] = { 'A', 'R', 'S', 'P' };
+static const uint32_t kSpoolVersion = 1;
+static const size_t kSpoolFileSize = sizeof(SpoolHeader) + kSpoolCapacity * sizeof(SpoolRecord);
+
+static std::mutex spoolMutex;
+static SpoolHeader *spoolHeader = NULL;
+static SpoolRecord *spoolRecords = NULL;
+static uint32_t nextSequence = 0;
+static std::atomic<uint32_t> droppedRecords(0);
+
+uint32_t fnv1a(const void* data, size_t size, uint32_t hash)
+{
+    const unsigned char *bytes = static_cast<const unsigned char*>(data);
+    for(size_t i = 0; i < size; i++) {
+        hash = (hash ^ bytes[i]) * 16777619u;
+    }
+    return hash;
+}
+
+static uint32_t recordChecksum(const SpoolRecord &record)
+{
+    uint32_t hash = fnv1a(&record.sequence, sizeof(record.sequence));
+    return fnv1a(&record.timeMs, sizeof(SpoolRecord) - offsetof(SpoolRecord, timeMs), hash);
+}
+
+static bool recordValid(const SpoolRecord &record, uint32_t sequence)
+{
+    return record.sequence == sequence && record.checksum == recordChecksum(record);
+}
+
+bool openSpool(const std::string& path)
+{
+    std::lock_guard<std::mutex> lock(spoolMutex);
+    if(spoolHeader != NULL) {
+        return true;
+    }
+    int fd = open(path.c_str(), O_RDWR | O_CREAT, 0644);
+    if(fd < 0) {
+        return false;
+    }
+    struct stat st;
+    if(fstat(fd, &st) != 0 || (st.st_size != (off_t)kSpoolFileSize && ftruncate(fd, kSpoolFileSize) != 0)) {
+        close(fd);
+        return false;
+    }
+    void *data = mmap(NULL, kSpoolFileSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    // the mapping keeps the file open
+    close(fd);
+    if(data == MAP_FAILED) {
+        return false;
+    }
+    SpoolHeader *header = static_cast<SpoolHeader*>(data);
+    if(memcmp(header->magic, kSpoolMagic, sizeof(kSpoolMagic)) != 0 || header->version != kSpoolVersion ||
+       header->recordSize != sizeof(SpoolRecord) || header->capacity != kSpoolCapacity || header->ackedSequence == 0) {
+        // new or foreign file; sequences start at 1 so zeroed slots never match
+        memset(data, 0, kSpoolFileSize);
+        memcpy(header->magic, kSpoolMagic, sizeof(kSpoolMagic));
+        header->version = kSpoolVersion;
+        header->recordSize = sizeof(SpoolRecord);
+        header->capacity = kSpoolCapacity;
+        header->ackedSequence = 1;
+    }
+    spoolHeader = header;
+    spoolRecords = reinterpret_cast<SpoolRecord*>(header + 1);
+    nextSequence = header->ackedSequence;
+    while(nextSequence - header->ackedSequence < kSpoolCapacity &&
+          recordValid(spoolRecords[nextSequence % kSpoolCapacity], nextSequence)) {
+        nextSequence++;
+    }
+    return true;
+}
+
+void appendSpool(uint8_t event, uint8_t format, const char* adUnit, uint32_t latencyMs, float value)
+{
+    SpoolRecord record;
+    memset(&record, 0, sizeof(record));
+    record.timeMs = (uint64_t)std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+    record.event = event;
+    record.format = format;
+    record.latencyMs = latencyMs;
+    record.value = value;
+    record.adUnitHash = adUnit != NULL ? fnv1a(adUnit, strlen(adUnit)) : 0;
+    std::lock_guard<std::mutex> lock(spoolMutex);
+    if(spoolHeader == NULL || nextSequence - spoolHeader->ackedSequence >= kSpoolCapacity) {
+        droppedRecords++;
+        return;
+    }
+    record.sequence = nextSequence;
+    record.checksum = recordChecksum(record);
+    spoolRecords[nextSequence % kSpoolCapacity] = record;
+    nextSequence++;
+}
+
+size_t readSpool(SpoolRecord* out, size_t max)
+{
+    std::lock_guard<std::mutex> lock(spoolMutex);
+    if(spoolHeader == NULL) {
+        return 0;
+    }
+    size_t count = 0;
+    for(uint32_t sequence = spoolHeader->ackedSequence; sequence != nextSequence && count < max; sequence++) {
+        out[count++] = spoolRecords[sequence % kSpoolCapacity];
+    }
+    return count;
+}
+
+void ackSpool(size_t count)
+{
+    std::lock_guard<std::mutex> lock(spoolMutex);
+    if(spoolHeader == NULL) {
+        return;
+    }
+    uint32_t pending = nextSequence - spoolHeader->ackedSequence;
+    spoolHeader->ackedSequence += count < pending ? (uint32_t)count : pending;
+    msync(spoolHeader, sizeof(SpoolHeader), MS_ASYNC);
+}
+
+size_t spoolPending()
+{
+    std::lock_guard<std::mutex> lock(spoolMutex);
+    return spoolHeader != NULL ? nextSequence - spoolHeader->ackedSequence : 0;
+}
+
+uint32_t spoolDropped()
+{
+    return droppedRecords.load();
+}
+
+} // namespace admob
+} // namespace sdkbar
@@ -0,0 +1,52 @@
+#ifndef AdMobSpool_h
+#define AdMobSpool_h
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+
+namespace sdkbar {
+namespace admob {
+
+// Offline ad telemetry. Every lifecycle event is appended as a fixed 32-byte
+// record to a memory-mapped file of bounded size, so telemetry costs the same
+// memory however long the session runs and survives a crash or kill. Records
+// are kept until the upload hook acknowledges them. Any thread.
+
+static const uint32_t kSpoolCapacity = 4096;
+
+// Little-endian on disk and in admob.read_telemetry() buffers.
+struct SpoolRecord {
+    uint32_t sequence;    // increases by one per record, never reused
+    uint32_t checksum;    // FNV-1a over the other 28 bytes
+    uint64_t timeMs;      // wall clock, ms since the epoch
+    uint8_t event;        // AdLifecycleEvent
+    uint8_t format;       // AdFormat
+    uint16_t reserved;
+    uint32_t latencyMs;
+    float value;          // reward amount
+    uint32_t adUnitHash;  // FNV-1a of the ad unit id
+};
+
+// Maps the spool file, creating it when missing. Records found in it from
+// earlier sessions are kept up to the first torn or corrupt one.
+bool openSpool(const std::string& path);
+
+// Dropped (and counted) when the spool is full or not open.
+void appendSpool(uint8_t event, uint8_t format, const char* adUnit, uint32_t latencyMs, float value);
+
+// Upload hook: copies up to max unacknowledged records, oldest first, and
+// returns the count. Once they are uploaded, ackSpool(count) releases them;
+// records that were never acknowledged are read again next time.
+size_t readSpool(SpoolRecord* out, size_t max);
+void ackSpool(size_t count);
+
+size_t spoolPending();
+uint32_t spoolDropped();
+
+uint32_t fnv1a(const void* data, size_t size, uint32_t hash = 2166136261u);
+
+} // namespace admob
+} // namespace sdkbar
+
+#endif /* AdMobSpool_h */
@@ -0,0 +1,123 @@
+#include "AdMobTrace.h"
+#include <atomic>
+#include <chrono>
+#include <sstream>
+
+namespace sdkbar {
+namespace admob {
+
+static const uint32_t kTraceCapacity = 4096; // power of two
+
+// Each record is guarded by a sequence number: odd while a writer is filling
+// it, 2 * (index + 1) once complete. Readers skip records that change under them.
+struct TraceRecord {
+    std::atomic<uint64_t> seq;
+    std::atomic<uint64_t> ts;
+    std::atomic<uint64_t> dur;
+    std::atomic<const char*> name;
+    std::atomic<uint32_t> tid;
+    std::atomic<uint8_t> event;
+    std::atomic<uint8_t> slot;
+};
+
+static TraceRecord traceRing[kTraceCapacity];
+static std::atomic<uint64_t> traceHead(0);
+static std::atomic<uint32_t> traceThreadCounter(0);
+
+static uint32_t traceThreadId()
+{
+    static thread_local uint32_t tid = ++traceThreadCounter;
+    return tid;
+}
+
+uint64_t traceNow()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void traceSpan(TraceEvent event, TraceSlot slot, const char* name, uint64_t start, uint64_t duration)
+{
+    uint64_t index = traceHead.fetch_add(1, std::memory_order_relaxed);
+    TraceRecord& rec = traceRing[index & (kTraceCapacity - 1)];
+    rec.seq.store(2 * index + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    rec.ts.store(start, std::memory_order_relaxed);
+    rec.dur.store(duration, std::memory_order_relaxed);
+    rec.name.store(name, std::memory_order_relaxed);
+    rec.tid.store(traceThreadId(), std::memory_order_relaxed);
+    rec.event.store((uint8_t)event, std::memory_order_relaxed);
+    rec.slot.store((uint8_t)slot, std::memory_order_relaxed);
+    rec.seq.store(2 * index + 2, std::memory_order_release);
+}
+
+void trace(TraceEvent event, TraceSlot slot, const char* name)
+{
+    traceSpan(event, slot, name, traceNow(), 0);
+}
+
+static const char* traceEventCategory(uint8_t event)
+{
+    switch(event) {
+        case kTraceJsEntry: return "js_entry";
+        case kTraceSdkCall: return "sdk_call";
+        case kTraceFutureComplete: return "future";
+        case kTraceSchedulerHop: return "scheduler";
+        case kTraceJsCallback: return "js_callback";
+        default: return "unknown";
+    }
+}
+
+static const char* traceSlotName(uint8_t slot)
+{
+    switch(slot) {
+        case kSlotBanner: return "banner";
+        case kSlotInterstitial: return "interstitial";
+        case kSlotRewarded: return "rewarded";
+        case kSlotConfig: return "config";
+        default: return "none";
+    }
+}
+
+std::string traceToChromeJson()
+{
+    uint64_t head = traceHead.load(std::memory_order_acquire);
+    uint64_t first = head > kTraceCapacity ? head - kTraceCapacity : 0;
+    std::ostringstream out;
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    bool comma = false;
+    for(uint64_t index = first; index < head; index++) {
+        TraceRecord& rec = traceRing[index & (kTraceCapacity - 1)];
+        uint64_t seq = rec.seq.load(std::memory_order_acquire);
+        if(seq != 2 * index + 2) {
+            // still being written or already overwritten
+            continue;
+        }
+        uint64_t ts = rec.ts.load(std::memory_order_relaxed);
+        uint64_t dur = rec.dur.load(std::memory_order_relaxed);
+        const char* name = rec.name.load(std::memory_order_relaxed);
+        uint32_t tid = rec.tid.load(std::memory_order_relaxed);
+        uint8_t event = rec.event.load(std::memory_order_relaxed);
+        uint8_t slot = rec.slot.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if(rec.seq.load(std::memory_order_relaxed) != seq) {
+            continue;
+        }
+        if(comma) {
+            out << ",";
+        }
+        comma = true;
+        out << "{\"name\":\"" << (name ? name : "") << "\",\"cat\":\"" << traceEventCategory(event)
+            << "\",\"pid\":1,\"tid\":" << tid << ",\"ts\":" << ts;
+        if(event == kTraceSdkCall) {
+            out << ",\"ph\":\"X\",\"dur\":" << dur;
+        } else {
+            out << ",\"ph\":\"i\",\"s\":\"t\"";
+        }
+        out << ",\"args\":{\"slot\":\"" << traceSlotName(slot) << "\"}}";
+    }
+    out << "]}";
+    return out.str();
+}
+
+} // namespace admob
+} // namespace sdkbar
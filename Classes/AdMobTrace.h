@@ -0,0 +1,44 @@
+#ifndef AdMobTrace_h
+#define AdMobTrace_h
+
+#include <stdint.h>
+#include <string>
+
+namespace sdkbar {
+namespace admob {
+
+// Always-on event tracer. Every plugin event lands in a fixed-size lock-free
+// ring buffer; the newest records can be dumped as Chrome trace_event JSON
+// (chrome://tracing, Perfetto) to see where time went across threads.
+
+enum TraceEvent {
+    kTraceJsEntry = 0,
+    kTraceSdkCall,
+    kTraceFutureComplete,
+    kTraceSchedulerHop,
+    kTraceJsCallback,
+};
+
+enum TraceSlot {
+    kSlotNone = 0,
+    kSlotBanner,
+    kSlotInterstitial,
+    kSlotRewarded,
+    kSlotConfig,
+};
+
+// Monotonic timestamp in microseconds.
+uint64_t traceNow();
+
+// `name` must point to static storage (string literal or __func__).
+void trace(TraceEvent event, TraceSlot slot, const char* name);
+void traceSpan(TraceEvent event, TraceSlot slot, const char* name, uint64_t start, uint64_t duration);
+
+std::string traceToChromeJson();
+
+} // namespace admob
+} // namespace sdkbar
+
+#define ADMOB_TRACE(event, slot, name) sdkbar::admob::trace(sdkbar::admob::event, sdkbar::admob::slot, name)
+
+#endif /* AdMobTrace_h */
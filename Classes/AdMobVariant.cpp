@@ -0,0 +1,269 @@
+#include "AdMobVariant.h"
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+#include "scripting/js-bindings/manual/js_manual_conversions.h"
+
+namespace sdkbar {
+namespace admob {
+
+static bool isAscii(const char *str, size_t length)
+{
+    for(size_t i = 0; i < length; i++) {
+        if((unsigned char)str[i] >= 0x80) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// ASCII is copied straight into a Latin-1 JS string; anything else goes
+// through the UTF-8 decoder.
+static bool stringToJsval(JSContext *cx, const char *str, JS::MutableHandleValue out)
+{
+    size_t length = strlen(str);
+    if(isAscii(str, length)) {
+        JSString *jsstr = JS_NewStringCopyN(cx, str, length);
+        if(jsstr == NULL) {
+            return false;
+        }
+        out.setString(jsstr);
+        return true;
+    }
+    out.set(c_string_to_jsval(cx, str, length));
+    return !out.isNullOrUndefined();
+}
+
+bool defineUtf8Property(JSContext* cx, JS::HandleObject target, const char* name, JS::HandleValue value)
+{
+    if(isAscii(name, strlen(name))) {
+        return JS_DefineProperty(cx, target, name, value, JSPROP_ENUMERATE);
+    }
+    JS::RootedValue nameVal(cx);
+    JS::RootedId id(cx);
+    return stringToJsval(cx, name, &nameVal) && JS_ValueToId(cx, nameVal, &id) &&
+        JS_DefinePropertyById(cx, target, id, value, JSPROP_ENUMERATE);
+}
+
+static bool defineKey(JSContext *cx, JS::HandleObject target, const firebase::Variant &key, JS::HandleValue value)
+{
+    if(key.is_string()) {
+        return defineUtf8Property(cx, target, key.string_value(), value);
+    }
+    if(key.is_int64() && key.int64_value() >= 0 && key.int64_value() <= UINT32_MAX) {
+        return JS_DefineElement(cx, target, (uint32_t)key.int64_value(), value, JSPROP_ENUMERATE);
+    }
+    char name[32];
+    if(key.is_int64()) {
+        snprintf(name, sizeof(name), "%lld", (long long)key.int64_value());
+    } else if(key.is_double()) {
+        snprintf(name, sizeof(name), "%.17g", key.double_value());
+    } else if(key.is_bool()) {
+        snprintf(name, sizeof(name), "%s", key.bool_value() ? "true" : "false");
+    } else if(key.is_null()) {
+        snprintf(name, sizeof(name), "null");
+    } else {
+        JS_ReportError(cx, "Unsupported Variant map key");
+        return false;
+    }
+    return JS_DefineProperty(cx, target, name, value, JSPROP_ENUMERATE);
+}
+
+// Converts a scalar, or creates the empty array/object for a container and
+// queues it to be filled.
+static bool variantNodeToJsval(JSContext *cx, const firebase::Variant &variant, JS::MutableHandleValue out,
+                               std::vector<const firebase::Variant*> &sources, JS::AutoObjectVector &targets)
+{
+    switch(variant.type()) {
+        case firebase::Variant::kTypeInt64: {
+            int64_t value = variant.int64_value();
+            if(value >= INT32_MIN && value <= INT32_MAX) {
+                out.setInt32((int32_t)value);
+            } else {
+                out.setDouble((double)value);
+            }
+            return true;
+        }
+        case firebase::Variant::kTypeDouble:
+            out.setDouble(variant.double_value());
+            return true;
+        case firebase::Variant::kTypeBool:
+            out.setBoolean(variant.bool_value());
+            return true;
+        case firebase::Variant::kTypeStaticString:
+        case firebase::Variant::kTypeMutableString:
+            return stringToJsval(cx, variant.string_value(), out);
+        case firebase::Variant::kTypeStaticBlob:
+        case firebase::Variant::kTypeMutableBlob: {
+            JSObject *buffer = JS_NewArrayBuffer(cx, variant.blob_size());
+            if(buffer == NULL) {
+                return false;
+            }
+            memcpy(JS_GetArrayBufferData(buffer), variant.blob_data(), variant.blob_size());
+            out.setObject(*buffer);
+            return true;
+        }
+        case firebase::Variant::kTypeVector:
+        case firebase::Variant::kTypeMap: {
+            JSObject *container = variant.is_vector() ?
+                JS_NewArrayObject(cx, variant.vector().size()) :
+                JS_NewObject(cx, NULL, JS::NullPtr(), JS::NullPtr());
+            if(container == NULL || !targets.append(container)) {
+                return false;
+            }
+            sources.push_back(&variant);
+            out.setObject(*container);
+            return true;
+        }
+        case firebase::Variant::kTypeNull:
+        default:
+            out.setNull();
+            return true;
+    }
+}
+
+bool variantToJsval(JSContext* cx, const firebase::Variant& variant, JS::MutableHandleValue out)
+{
+    std::vector<const firebase::Variant*> sources;
+    JS::AutoObjectVector targets(cx);
+    if(!variantNodeToJsval(cx, variant, out, sources, targets)) {
+        return false;
+    }
+    JS::RootedObject target(cx);
+    JS::RootedValue child(cx);
+    while(!sources.empty()) {
+        const firebase::Variant *source = sources.back();
+        target = targets[targets.length() - 1];
+        sources.pop_back();
+        targets.popBack();
+        if(source->is_vector()) {
+            const std::vector<firebase::Variant> &items = source->vector();
+            for(size_t i = 0; i < items.size(); i++) {
+                if(!variantNodeToJsval(cx, items[i], &child, sources, targets) ||
+                   !JS_DefineElement(cx, target, (uint32_t)i, child, JSPROP_ENUMERATE)) {
+                    return false;
+                }
+            }
+        } else {
+            const std::map<firebase::Variant, firebase::Variant> &items = source->map();
+            for(std::map<firebase::Variant, firebase::Variant>::const_iterator it = items.begin(); it != items.end(); ++it) {
+                if(!variantNodeToJsval(cx, it->second, &child, sources, targets) ||
+                   !defineKey(cx, target, it->first, child)) {
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+// Converts a scalar in place, or turns out into an empty vector/map and
+// queues the JS object to be walked.
+static bool jsvalNodeToVariant(JSContext *cx, JS::HandleValue value, firebase::Variant *out, uint32_t depth,
+                               JS::AutoObjectVector &sources, std::vector<firebase::Variant*> &targets,
+                               std::vector<uint32_t> &depths)
+{
+    if(value.isInt32()) {
+        *out = firebase::Variant::FromInt64(value.toInt32());
+    } else if(value.isNumber()) {
+        *out = firebase::Variant::FromDouble(value.toNumber());
+    } else if(value.isBoolean()) {
+        *out = firebase::Variant::FromBool(value.toBoolean());
+    } else if(value.isString()) {
+        std::string str;
+        if(!jsval_to_std_string(cx, value, &str)) {
+            return false;
+        }
+        *out = firebase::Variant::FromMutableString(str);
+    } else if(value.isObject()) {
+        JSObject *obj = &value.toObject();
+        if(JS_IsArrayBufferObject(obj)) {
+            *out = firebase::Variant::FromMutableBlob(JS_GetArrayBufferData(obj), JS_GetArrayBufferByteLength(obj));
+        } else if(JS_IsArrayBufferViewObject(obj)) {
+            *out = firebase::Variant::FromMutableBlob(JS_GetArrayBufferViewData(obj), JS_GetArrayBufferViewByteLength(obj));
+        } else if(JS_ObjectIsFunction(cx, obj)) {
+            *out = firebase::Variant::Null();
+        } else {
+            if(depth >= kMaxVariantDepth) {
+                JS_ReportError(cx, "Value nested too deeply");
+                return false;
+            }
+            JS::RootedObject container(cx, obj);
+            *out = JS_IsArrayObject(cx, container) ? firebase::Variant::EmptyVector() : firebase::Variant::EmptyMap();
+            if(!sources.append(container)) {
+                return false;
+            }
+            targets.push_back(out);
+            depths.push_back(depth + 1);
+        }
+    } else {
+        *out = firebase::Variant::Null();
+    }
+    return true;
+}
+
+bool jsvalToVariant(JSContext* cx, JS::HandleValue value, firebase::Variant* out)
+{
+    JS::AutoObjectVector sources(cx);
+    std::vector<firebase::Variant*> targets;
+    std::vector<uint32_t> depths;
+    if(!jsvalNodeToVariant(cx, value, out, 0, sources, targets, depths)) {
+        return false;
+    }
+    JS::RootedObject source(cx);
+    JS::RootedObject it(cx);
+    JS::RootedId id(cx);
+    JS::RootedValue key(cx);
+    JS::RootedValue child(cx);
+    std::string keyBuffer;
+    while(!targets.empty()) {
+        source = sources[sources.length() - 1];
+        firebase::Variant *target = targets.back();
+        uint32_t depth = depths.back();
+        sources.popBack();
+        targets.pop_back();
+        depths.pop_back();
+        if(target->is_vector()) {
+            uint32_t length = 0;
+            if(!JS_GetArrayLength(cx, source, &length)) {
+                return false;
+            }
+            // sized up front, so queued element pointers stay valid
+            std::vector<firebase::Variant> &items = target->vector();
+            items.resize(length);
+            for(uint32_t i = 0; i < length; i++) {
+                if(!JS_GetElement(cx, source, i, &child) ||
+                   !jsvalNodeToVariant(cx, child, &items[i], depth, sources, targets, depths)) {
+                    return false;
+                }
+            }
+        } else {
+            // map nodes never move, so queued value pointers stay valid
+            std::map<firebase::Variant, firebase::Variant> &items = target->map();
+            it = JS_NewPropertyIterator(cx, source);
+            if(!it) {
+                return false;
+            }
+            for(;;) {
+                if(!JS_NextProperty(cx, it, id.address())) {
+                    return false;
+                }
+                if(JSID_IS_VOID(id)) {
+                    break;
+                }
+                if(!JS_IdToValue(cx, id, &key) || !jsval_to_std_string(cx, key, &keyBuffer) ||
+                   !JS_GetPropertyById(cx, source, id, &child)) {
+                    return false;
+                }
+                firebase::Variant &item = items[firebase::Variant::FromMutableString(keyBuffer)];
+                if(!jsvalNodeToVariant(cx, child, &item, depth, sources, targets, depths)) {
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+} // namespace admob
+} // namespace sdkbar
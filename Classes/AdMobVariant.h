@@ -0,0 +1,35 @@
+#ifndef AdMobVariant_h
+#define AdMobVariant_h
+
+#include "jsapi.h"
+#include "firebase/variant.h"
+
+namespace sdkbar {
+namespace admob {
+
+// firebase::Variant <-> JS conversion for Remote Config defaults and live-ops
+// payloads. Both directions walk containers with an explicit worklist, so
+// nesting depth costs heap, not C stack, and every node is visited once.
+//
+// Variant -> JS: vectors become arrays, maps objects (scalar keys are used as
+// property names), blobs ArrayBuffers, int64 an int32 or a double (exact up
+// to 2^53). Strings are read in place, static or mutable, and copied once
+// into the JS heap.
+//
+// JS -> Variant: arrays become vectors, ArrayBuffers and typed arrays mutable
+// blobs, other objects maps with string keys, int32 int64, other numbers
+// doubles, undefined and functions null. Nesting beyond kMaxVariantDepth
+// (e.g. a cycle) fails the conversion.
+
+static const uint32_t kMaxVariantDepth = 128;
+
+bool variantToJsval(JSContext* cx, const firebase::Variant& variant, JS::MutableHandleValue out);
+bool jsvalToVariant(JSContext* cx, JS::HandleValue value, firebase::Variant* out);
+
+// Defines an enumerable property with a UTF-8 name.
+bool defineUtf8Property(JSContext* cx, JS::HandleObject target, const char* name, JS::HandleValue value);
+
+} // namespace admob
+} // namespace sdkbar
+
+#endif /* AdMobVariant_h */
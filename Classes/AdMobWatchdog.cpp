@@ -0,0 +1,104 @@
+#include "AdMobWatchdog.h"
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+namespace sdkbar {
+namespace admob {
+
+static const size_t kStallReportCapacity = 64;
+
+struct StallRecord {
+    const char* name;
+    std::string adUnit;
+    const char* caller;
+    uint64_t start;
+    uint64_t duration;
+};
+
+static std::atomic<uint64_t> stallBudgetUs(0);
+static std::mutex stallMutex;
+static std::deque<StallRecord> stallReport;
+static uint64_t stallCount = 0;
+// the render thread, captured by setStallBudget
+static std::thread::id watchedThread;
+
+void setStallBudget(uint32_t budgetMs)
+{
+    {
+        std::lock_guard<std::mutex> lock(stallMutex);
+        watchedThread = std::this_thread::get_id();
+    }
+    stallBudgetUs.store((uint64_t)budgetMs * 1000, std::memory_order_relaxed);
+}
+
+SdkCallScope::~SdkCallScope()
+{
+    uint64_t duration = traceNow() - _start;
+    traceSpan(kTraceSdkCall, _slot, _name, _start, duration);
+    uint64_t budget = stallBudgetUs.load(std::memory_order_relaxed);
+    if(budget == 0 || duration <= budget) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(stallMutex);
+    if(std::this_thread::get_id() != watchedThread) {
+        return;
+    }
+    StallRecord record = { _name, _adUnit ? _adUnit : "", _caller, _start, duration };
+    if(stallReport.size() == kStallReportCapacity) {
+        stallReport.pop_front();
+    }
+    stallReport.push_back(record);
+    stallCount++;
+}
+
+static void writeJsonString(std::ostringstream& out, const char* str)
+{
+    if(str == NULL) {
+        out << "null";
+        return;
+    }
+    out << '"';
+    for(const char* p = str; *p; p++) {
+        if(*p == '"' || *p == '\\') {
+            out << '\\';
+        }
+        out << *p;
+    }
+    out << '"';
+}
+
+std::string stallReportToJson()
+{
+    std::lock_guard<std::mutex> lock(stallMutex);
+    std::ostringstream out;
+    out << "{\"budget_ms\":" << stallBudgetUs.load(std::memory_order_relaxed) / 1000
+        << ",\"total\":" << stallCount << ",\"stalls\":[";
+    for(size_t i = 0; i < stallReport.size(); i++) {
+        const StallRecord& record = stallReport[i];
+        if(i > 0) {
+            out << ",";
+        }
+        out << "{\"call\":";
+        writeJsonString(out, record.name);
+        out << ",\"ad_unit\":";
+        writeJsonString(out, record.adUnit.c_str());
+        out << ",\"caller\":";
+        writeJsonString(out, record.caller);
+        out << ",\"ts\":" << record.start << ",\"ms\":" << record.duration / 1000.0 << "}";
+    }
+    out << "]}";
+    return out.str();
+}
+
+void clearStallReport()
+{
+    std::lock_guard<std::mutex> lock(stallMutex);
+    stallReport.clear();
+    stallCount = 0;
+}
+
+} // namespace admob
+} // namespace sdkbar
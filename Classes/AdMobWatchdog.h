@@ -0,0 +1,48 @@
+#ifndef AdMobWatchdog_h
+#define AdMobWatchdog_h
+
+#include "AdMobTrace.h"
+
+namespace sdkbar {
+namespace admob {
+
+// Optional main-thread stall watchdog. Synchronous SDK calls are timed and
+// the ones that exceed the budget are kept in a small stall report together
+// with the ad unit and the call site.
+
+// Budget in milliseconds, 0 disables the watchdog (default). Call it from the
+// cocos thread: only stalls on the calling thread are reported, calls on the
+// AdMob worker and SDK completion threads block no frame and only get their
+// trace span.
+void setStallBudget(uint32_t budgetMs);
+
+std::string stallReportToJson();
+void clearStallReport();
+
+// Times one synchronous SDK call: always records a trace span, and a stall
+// entry when the watchdog is enabled and the call ran over budget on the
+// watched thread.
+// `name` and `caller` must point to static storage; `adUnit` (or the config
+// key) is copied only when a stall is recorded.
+class SdkCallScope {
+public:
+    SdkCallScope(TraceSlot slot, const char* name, const char* adUnit, const char* caller)
+        : _slot(slot), _name(name), _adUnit(adUnit), _caller(caller), _start(traceNow()) {}
+    ~SdkCallScope();
+private:
+    SdkCallScope(const SdkCallScope&);
+    SdkCallScope& operator=(const SdkCallScope&);
+    TraceSlot _slot;
+    const char* _name;
+    const char* _adUnit;
+    const char* _caller;
+    uint64_t _start;
+};
+
+} // namespace admob
+} // namespace sdkbar
+
+#define ADMOB_SDK_CALL_FROM(caller, slot, name, adUnit, ...) do { sdkbar::admob::SdkCallScope _admobSdkCall(sdkbar::admob::slot, name, adUnit, caller); __VA_ARGS__; } while(0)
+#define ADMOB_SDK_CALL(slot, name, adUnit, ...) ADMOB_SDK_CALL_FROM(__func__, slot, name, adUnit, __VA_ARGS__)
+
+#endif /* AdMobWatchdog_h */
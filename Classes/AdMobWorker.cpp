@@ -0,0 +1,125 @@
+#include "AdMobWorker.h"
+#include <atomic>
+#include <condition_variable>
+#include <thread>
+
+namespace sdkbar {
+namespace admob {
+
+static std::atomic<bool> offThread(false);
+// Guards mode switches against dispatched calls still in flight.
+static std::mutex modeMutex;
+static int dispatchedCalls = 0;
+static std::function<void()> workerInit;
+static std::mutex workerMutex;
+static std::condition_variable workerCondition;
+static std::deque<std::function<void()> > workerJobs;
+static bool workerStarted = false;
+
+static void workerLoop()
+{
+    if(workerInit) {
+        workerInit();
+    }
+    for(;;) {
+        std::function<void()> job;
+        {
+            std::unique_lock<std::mutex> lock(workerMutex);
+            while(workerJobs.empty()) {
+                workerCondition.wait(lock);
+            }
+            job.swap(workerJobs.front());
+            workerJobs.pop_front();
+        }
+        job();
+    }
+}
+
+static void workerPost(const std::function<void()>& job)
+{
+    std::lock_guard<std::mutex> lock(workerMutex);
+    if(!workerStarted) {
+        // lives for the whole process, like the SDK itself
+        std::thread(workerLoop).detach();
+        workerStarted = true;
+    }
+    workerJobs.push_back(job);
+    workerCondition.notify_one();
+}
+
+void setWorkerThreadInit(const std::function<void()>& init)
+{
+    std::lock_guard<std::mutex> lock(workerMutex);
+    workerInit = init;
+}
+
+bool setOffThreadSdkCalls(bool enabled)
+{
+    std::lock_guard<std::mutex> lock(modeMutex);
+    if(enabled != offThread.load() && dispatchedCalls > 0) {
+        return false;
+    }
+    offThread.store(enabled);
+    return true;
+}
+
+bool offThreadSdkCalls()
+{
+    return offThread.load();
+}
+
+void SerialQueue::post(const std::function<void()>& task)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _tasks.push_back(task);
+    if(!_scheduled) {
+        _scheduled = true;
+        workerPost([this] { runOne(); });
+    }
+}
+
+static void dispatchDone()
+{
+    std::lock_guard<std::mutex> lock(modeMutex);
+    dispatchedCalls--;
+}
+
+void SerialQueue::dispatch(const std::function<void()>& task)
+{
+    bool queued;
+    {
+        std::lock_guard<std::mutex> lock(modeMutex);
+        dispatchedCalls++;
+        queued = offThread.load();
+    }
+    if(queued) {
+        post([task] {
+                task();
+                dispatchDone();
+            });
+    } else {
+        task();
+        dispatchDone();
+    }
+}
+
+void SerialQueue::runOne()
+{
+    std::function<void()> task;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        task.swap(_tasks.front());
+        _tasks.pop_front();
+    }
+    task();
+    std::lock_guard<std::mutex> lock(_mutex);
+    if(_tasks.empty()) {
+        _scheduled = false;
+    } else {
+        // requeue behind the other queues instead of draining in one go
+        workerPost([this] { runOne(); });
+    }
+}
+
+} // namespace admob
+} // namespace sdkbar
@@ -0,0 +1,44 @@
+#ifndef AdMobWorker_h
+#define AdMobWorker_h
+
+#include <deque>
+#include <functional>
+#include <mutex>
+
+namespace sdkbar {
+namespace admob {
+
+// Dedicated worker thread for blocking SDK calls (Initialize, LoadAd, Destroy)
+// so the cocos/JS thread never waits on AdMob.
+
+// Called once on the worker thread before the first task, e.g. to attach
+// the thread to the JVM on Android. Must be set before the first post().
+void setWorkerThreadInit(const std::function<void()>& init);
+
+// When disabled (default) SDK calls stay on the calling thread. Switching
+// modes is refused (false) while any dispatched call is queued or running,
+// so calls on one ad object never run on both sides of the switch.
+bool setOffThreadSdkCalls(bool enabled);
+bool offThreadSdkCalls();
+
+// Tasks posted to one queue run on the worker thread strictly in posting
+// order; different queues are interleaved task by task.
+class SerialQueue {
+public:
+    SerialQueue() : _scheduled(false) {}
+    void post(const std::function<void()>& task);
+    // Runs task inline, or posts it when off-thread SDK calls are enabled.
+    void dispatch(const std::function<void()>& task);
+private:
+    SerialQueue(const SerialQueue&);
+    SerialQueue& operator=(const SerialQueue&);
+    void runOne();
+    std::mutex _mutex;
+    std::deque<std::function<void()> > _tasks;
+    bool _scheduled;
+};
+
+} // namespace admob
+} // namespace sdkbar
+
+#endif /* AdMobWorker_h */
@@ -0,0 +1,59 @@
+#!/usr/bin/env python3
+"""Build the Remote Config defaults blob read by admob.init / set_config_defaults.
+
+usage: build_config_defaults.py defaults.json out.bin
+
+The JSON file is a flat object of key -> bool, integer, number or string.
+The layout is documented in Classes/AdMobConfigDefaults.h.
+"""
+
+import json
+import struct
+import sys
+
+VERSION = 1
+TYPE_BOOL, TYPE_INT64, TYPE_DOUBLE, TYPE_STRING = range(4)
+
+
+def build(defaults):
+    pool = bytearray()
+    offsets = {}
+
+    def intern(s):
+        if s not in offsets:
+            offsets[s] = len(pool)
+            pool.extend(s.encode('utf-8') + b'\0')
+        return offsets[s]
+
+    entries = bytearray()
+    for key in sorted(defaults):
+        value = defaults[key]
+        if isinstance(value, bool):
+            kind, raw = TYPE_BOOL, struct.pack('<Q', int(value))
+        elif isinstance(value, int):
+            kind, raw = TYPE_INT64, struct.pack('<q', value)
+        elif isinstance(value, float):
+            kind, raw = TYPE_DOUBLE, struct.pack('<d', value)
+        elif isinstance(value, str):
+            kind, raw = TYPE_STRING, struct.pack('<Q', intern(value))
+        else:
+            raise ValueError('unsupported value for %r: %r' % (key, value))
+        entries += struct.pack('<IB3x', intern(key), kind) + raw
+
+    header = b'ARCD' + struct.pack('<III', VERSION, len(defaults), 16 + len(entries))
+    return bytes(header + entries + pool)
+
+
+def main(argv):
+    if len(argv) != 3:
+        sys.exit(__doc__.strip())
+    with open(argv[1]) as f:
+        defaults = json.load(f)
+    if not isinstance(defaults, dict):
+        sys.exit('%s: expected a JSON object' % argv[1])
+    with open(argv[2], 'wb') as f:
+        f.write(build(defaults))
+
+
+if __name__ == '__main__':
+    main(sys.argv)